@@ -0,0 +1,172 @@
+/**
+ * @file allocator.h
+ * @brief Cabecera para allocator.c
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+typedef struct _poolSlab PoolSlab;
+typedef struct _memoryPool MemoryPool;
+typedef struct _arenaChunk ArenaChunk;
+typedef struct _stringArena StringArena;
+typedef struct _poolCache PoolCache;
+typedef struct _allocatorCache AllocatorCache;
+
+/**
+ * @def POOL_USERS
+ * @brief Pools de estructuras de tamaño fijo: usuarios, adyacencias y publicaciones (@see pool_alloc)
+ */
+#define POOL_USERS 0
+#define POOL_EDGES 1
+#define POOL_POSTS 2
+#define NUM_POOLS 3
+
+/**
+ * @def POOL_SLAB_OBJECTS
+ * @brief Cantidad de estructuras que se reservan juntas en cada bloque de un pool
+ */
+#define POOL_SLAB_OBJECTS 1024
+
+/**
+ * @def POOL_ALIGNMENT
+ * @brief Alineación de cada estructura de un pool (la misma que garantiza malloc)
+ */
+#define POOL_ALIGNMENT 16
+
+/**
+ * @def ARENA_INITIAL_CHUNK
+ * @brief Bytes del primer bloque de la arena de strings; cada bloque nuevo duplica al anterior hasta ARENA_MAX_CHUNK
+ * @note Al crecer de forma geométrica hay pocos bloques, así saber si un string es de la arena recorre pocos bloques
+ */
+#define ARENA_INITIAL_CHUNK (64 * 1024)
+
+/**
+ * @def ARENA_MAX_CHUNK
+ * @brief Bytes máximos de un bloque de la arena de strings (un string más largo usa un bloque propio)
+ */
+#define ARENA_MAX_CHUNK (16 * 1024 * 1024)
+
+/**
+ * @def ARENA_INITIAL_CHUNK_SLOTS
+ * @brief Capacidad inicial del arreglo de bloques de la arena de strings; luego se duplica cada vez que se llena
+ */
+#define ARENA_INITIAL_CHUNK_SLOTS 16
+
+/**
+ * @struct _poolSlab
+ * @brief Bloque de un pool, seguido de POOL_SLAB_OBJECTS estructuras
+ */
+struct _poolSlab{
+    PoolSlab *next; /*!< Bloque reservado anteriormente */
+};
+
+/**
+ * @struct _memoryPool
+ * @brief Pool de estructuras de un mismo tamaño: se reservan por bloques y las liberadas se reutilizan
+ */
+struct _memoryPool{
+    const char *name; /*!< Nombre para las estadísticas */
+    size_t objectSize; /*!< Bytes de cada estructura, redondeados a POOL_ALIGNMENT */
+    PoolSlab *slabs; /*!< Bloques reservados */
+    void *freeList; /*!< Estructuras liberadas, cada una guarda la siguiente en sus primeros bytes */
+    char *next; /*!< Siguiente estructura sin usar del último bloque */
+    char *end; /*!< Fin del último bloque */
+    long long numSlabs; /*!< Cantidad de bloques */
+    long long inUse; /*!< Estructuras entregadas y no liberadas */
+    long long peakInUse; /*!< Máximo de inUse */
+    long long allocations; /*!< Total de estructuras entregadas */
+    pthread_mutex_t lock; /*!< Para reservar y liberar desde varios hilos (el cargador usa @see AllocatorCache) */
+};
+
+/**
+ * @struct _arenaChunk
+ * @brief Bloque de la arena de strings, seguido de sus bytes
+ */
+struct _arenaChunk{
+    size_t size; /*!< Bytes del bloque */
+    size_t used; /*!< Bytes usados */
+    long long live; /*!< Strings del bloque que aún no se liberan */
+};
+
+/**
+ * @struct _stringArena
+ * @brief Arena de strings: se copian uno tras otro en bloques grandes
+ * @note Sirve para strings que casi no cambian (nombres, contraseñas y publicaciones). Un string liberado no se puede
+ *       reutilizar por separado: su bloque se devuelve a malloc recién cuando todos sus strings se liberan. Por eso los
+ *       strings que se reemplazan mientras corre el programa (por ejemplo al editar la cuenta) se reservan con malloc, así el
+ *       servidor no acumula en la arena strings que ya no usa
+ */
+struct _stringArena{
+    ArenaChunk **chunks; /*!< Bloques ordenados por dirección, para encontrar el de un string con búsqueda binaria */
+    long long numChunks; /*!< Cantidad de bloques */
+    long long chunkCapacity; /*!< Capacidad del arreglo chunks */
+    ArenaChunk *current; /*!< Bloque donde se copian los strings nuevos */
+    size_t nextChunkSize; /*!< Bytes del próximo bloque */
+    long long reservedBytes; /*!< Bytes reservados en bloques */
+    long long usedBytes; /*!< Bytes ocupados por strings */
+    long long releasedBytes; /*!< Bytes de strings que ya no se usan, en bloques que aún tienen strings en uso */
+    long long reclaimedBytes; /*!< Bytes de bloques devueltos porque ya no tenían strings en uso */
+    long long strings; /*!< Cantidad de strings copiados */
+    pthread_mutex_t lock; /*!< Para copiar y liberar desde varios hilos (el cargador usa @see AllocatorCache) */
+};
+
+/**
+ * @struct _poolCache
+ * @brief Bloques de un pool que reservó un hilo con @see AllocatorCache, aún no juntados al pool
+ */
+struct _poolCache{
+    PoolSlab *slabs; /*!< Bloques reservados por el hilo */
+    char *next; /*!< Siguiente estructura sin usar del último bloque */
+    char *end; /*!< Fin del último bloque */
+    long long numSlabs; /*!< Cantidad de bloques */
+    long long allocations; /*!< Estructuras entregadas */
+};
+
+/**
+ * @struct _allocatorCache
+ * @brief Bloques propios de un hilo del cargador, para reservar estructuras y copiar strings sin tomar los locks globales
+ * @note Se activa en el hilo con @see allocator_cache_begin y se junta a los pools y la arena con @see allocator_cache_merge
+ *       cuando el hilo terminó. Mientras tanto los strings copiados por el hilo no se pueden liberar con @see arena_release
+ */
+struct _allocatorCache{
+    PoolCache pools[NUM_POOLS]; /*!< Bloques de cada pool */
+    ArenaChunk **chunks; /*!< Bloques de strings reservados por el hilo */
+    long long numChunks; /*!< Cantidad de bloques de strings */
+    long long chunkCapacity; /*!< Capacidad del arreglo chunks */
+    ArenaChunk *current; /*!< Bloque donde se copian los strings nuevos */
+    size_t nextChunkSize; /*!< Bytes del próximo bloque de strings */
+    long long usedBytes; /*!< Bytes ocupados por strings */
+    long long strings; /*!< Cantidad de strings copiados */
+};
+
+/* FUNCIONES DE LOS POOLS */
+void *pool_alloc(int pool);
+void pool_free(int pool, void *object);
+
+/* FUNCIONES DE LA ARENA DE STRINGS */
+char *arena_strdup(const char *string);
+int arena_release(const void *string);
+
+/* CACHÉS POR HILO */
+void allocator_cache_begin(AllocatorCache *cache);
+void allocator_cache_end(void);
+void allocator_cache_merge(AllocatorCache *cache);
+
+/* ESTADÍSTICAS Y LIBERACIÓN */
+void print_memory_stats(void);
+void release_all_memory(void);
+
+#endif
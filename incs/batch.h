@@ -0,0 +1,51 @@
+/**
+ * @file batch.h
+ * @brief Cabecera para batch.c
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "commands.h"
+
+/* typedefs para evitar errores de compilación */
+typedef struct _globalInterests GlobalInterests;
+typedef struct _graph *Graph;
+typedef struct _hashtable HashTable;
+typedef HashTable* PtrToHashTable;
+/* -------------------------------------------- */
+
+/**
+ * @def BATCH_MAX_ARGS
+ * @brief Cantidad máxima de argumentos de un comando del lote, sin contar el usuario
+ */
+#define BATCH_MAX_ARGS 16
+
+/**
+ * @def BATCH_SESSION_USER
+ * @brief Usuario de una línea del lote que indica que el comando usa la sesión iniciada, como en la terminal
+ */
+#define BATCH_SESSION_USER "-"
+
+/**
+ * @def BATCH_INPUT_SEPARATOR
+ * @brief Separa el comando de la entrada que lee, en una línea del lote
+ */
+#define BATCH_INPUT_SEPARATOR '|'
+
+/* FUNCIONES DE EJECUCIÓN POR LOTES */
+int run_batch(const char *path, PtrToHashTable table, Graph graph, GlobalInterests globalInterests);
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * @file commands.h
+ * @brief Cabecera para commands.c
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "users.h"
+#include "heaps.h"
+#include "graph.h"
+#include "hash_table.h"
+#include "utilities.h"
+#include "database.h"
+#include "similarity.h"
+
+/* typedefs para evitar errores de compilación */
+typedef struct _globalInterests GlobalInterests;
+typedef struct _graph *Graph;
+typedef struct _hashtable HashTable;
+typedef HashTable* PtrToHashTable;
+/* -------------------------------------------- */
+
+/**
+ * @def COMMAND_OK
+ * @brief Resultados de un comando: terminó bien, falló o requiere una sesión iniciada que no existe
+ */
+#define COMMAND_OK 0
+#define COMMAND_ERROR 1
+#define COMMAND_NO_SESSION 2
+
+/**
+ * @def OPTION_SERVE
+ * @brief Opciones de get_option para el servidor, el cliente y la ejecución por lotes, @see server.h y batch.h
+ */
+#define OPTION_SERVE 24
+#define OPTION_CLIENT 25
+#define OPTION_BATCH 26
+
+int command_requires_session(int option);
+int command_reads_input(int option);
+int run_command(int option, int argc, char *argv[], PtrToHashTable table, Graph graph, GlobalInterests globalInterestsTable, User sessionUser);
+int run_command_captured(int argc, char *argv[], User sessionUser, char *input, size_t inputLength, char **output, size_t *outputLength,
+                         PtrToHashTable table, Graph graph, GlobalInterests globalInterestsTable);
+
+#endif
@@ -16,11 +16,17 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <dirent.h>
 #include <unistd.h>
 #include <time.h>
+#include <pthread.h>
+#include <errno.h>
+#include <sys/file.h>
 
 #include "users.h"
 #include "graph.h"
@@ -34,37 +40,253 @@ typedef struct _postNode PostNode;
 typedef PostNode *PtrToPostNode;
 typedef PtrToPostNode PostsPosition;
 typedef PtrToPostNode UserPosts;
-typedef struct _interest Interest;
-typedef Interest *InterestTable;
-typedef Interest *PtrToInterest;
+typedef unsigned long long InterestWord;
+typedef InterestWord *InterestTable;
 typedef struct _globalInterests GlobalInterests;
 typedef struct _edge *Edge;
 typedef struct _graph *Graph;
 typedef struct _hashnode Hashnode;
 typedef struct _hashtable HashTable;
 typedef HashTable* PtrToHashTable;
+/* -------------------------------------------- */
+
+typedef struct _snapshotHeader SnapshotHeader;
+typedef struct _snapshotUser SnapshotUser;
+typedef struct _snapshotPost SnapshotPost;
+typedef struct _walHeader WalHeader;
+typedef struct _walRecord WalRecord;
+
+/**
+ * @def DATABASE_SNAPSHOT_FILE
+ * @brief Archivo único con toda la base de datos en formato binario
+ * @note Si existe se usa en vez de las carpetas "database/{username}_data"
+ */
+#define DATABASE_SNAPSHOT_FILE "database/snapshot.dat"
+
+/**
+ * @def DATABASE_NEXT_ID_FILE
+ * @brief Siguiente id libre del grafo en la base de datos por carpetas
+ * @note Sin él los ids se recalculan como el mayor id guardado + 1, y el id de la última cuenta borrada se volvería a entregar
+ */
+#define DATABASE_NEXT_ID_FILE "database/next_id.dat"
+
+/**
+ * @def SNAPSHOT_MAGIC
+ * @brief Firma al inicio del archivo de snapshot
+ */
+#define SNAPSHOT_MAGIC "DGSNAP"
+
+/**
+ * @def SNAPSHOT_VERSION
+ * @brief Versión del formato de snapshot que se escribe
+ * @note Al cargar también se acepta la versión 1, que no tiene los índices para la carga parcial (@see open_database)
+ */
+#define SNAPSHOT_VERSION 2
+
+/**
+ * @def SNAPSHOT_V1_HEADER_SIZE
+ * @brief Tamaño del encabezado de la versión 1 del snapshot (hasta postsOffset)
+ */
+#define SNAPSHOT_V1_HEADER_SIZE (offsetof(SnapshotHeader, usersByIdOffset))
+
+/**
+ * @def LAZY_USER_NOT_LOADED
+ * @brief Estados de un registro del snapshot en la carga parcial: sin cargar, cargado sin todas sus conexiones,
+ *        cargado con sus conexiones y borrado
+ */
+#define LAZY_USER_NOT_LOADED 0
+#define LAZY_USER_PARTIAL 1
+#define LAZY_USER_LOADED 2
+#define LAZY_USER_DELETED 3
+
+/**
+ * @def DATABASE_LOCK_FILE
+ * @brief Archivo sobre el que se toma el flock de la base de datos, @see lock_database
+ * @note No cuenta como datos: una carpeta 'database' que solo lo tiene está vacía
+ */
+#define DATABASE_LOCK_FILE "database/lock"
+
+/**
+ * @def DATABASE_LOAD_MAX_THREADS
+ * @brief Cantidad máxima de hilos al cargar las carpetas de usuarios
+ */
+#define DATABASE_LOAD_MAX_THREADS 64
+
+/**
+ * @def WAL_FILE
+ * @brief Registro de cambios (write-ahead log) pendientes de incorporar al snapshot
+ */
+#define WAL_FILE "database/wal.dat"
+
+/**
+ * @def WAL_MAGIC
+ * @brief Firma al inicio del WAL
+ */
+#define WAL_MAGIC "DGWAL"
+
+/**
+ * @def WAL_GROUP_COMMIT_SIZE
+ * @brief Bytes de registros acumulados en memoria que fuerzan escribirlos al WAL antes de @see flush_database
+ */
+#define WAL_GROUP_COMMIT_SIZE (64 * 1024)
+
+/**
+ * @def WAL_COMPACT_SIZE
+ * @brief Tamaño del WAL (en bytes) desde el que se incorpora al snapshot al guardar
+ */
+#define WAL_COMPACT_SIZE (4 * 1024 * 1024)
+
+/**
+ * @def WAL_FOLLOW
+ * @brief Tipos de registro del WAL
+ */
+#define WAL_FOLLOW 1
+#define WAL_UNFOLLOW 2
+#define WAL_POST 3
+#define WAL_EDIT_NAME 4
+#define WAL_EDIT_USERNAME 5
+#define WAL_EDIT_PASSWORD 6
+#define WAL_REGISTER 7
+#define WAL_DELETE 8
+
+/**
+ * @struct _snapshotHeader
+ * @brief Encabezado del snapshot: cantidades y posición (en bytes desde el inicio) de cada sección
+ * @note Los números se guardan en el formato nativo de la máquina y cada sección empieza en un múltiplo de 8 bytes.
+ *       Las secciones son: tabla de strings (terminados en '\0'), registros de usuarios, intereses (numWords palabras por usuario,
+ *       en el orden de los registros), adyacencia de seguidos en formato CSR por id (inicios, destinos y pesos) y posts.
+ *       Desde la versión 2 siguen el registro de cada id, un índice de nombres de usuario (tabla hash con sondeo lineal
+ *       de posiciones de registros, -1 si está vacía) y la adyacencia de seguidores en formato CSR, usados en la carga parcial.
+ */
+struct _snapshotHeader{
+    char magic[8]; /*!< SNAPSHOT_MAGIC */
+    int version; /*!< SNAPSHOT_VERSION */
+    int numUsers; /*!< Cantidad de registros de usuarios */
+    int numNodes; /*!< Cantidad de ids (nextId del grafo) */
+    int numInterests; /*!< Cantidad de intereses globales al guardar */
+    int numWords; /*!< Palabras por conjunto de bits de intereses */
+    int walGeneration; /*!< Generación del WAL que ya está incorporada en el snapshot */
+    long long numEdges; /*!< Cantidad de aristas de seguidos */
+    long long numPosts; /*!< Cantidad de posts */
+    long long stringsOffset; /*!< Inicio de la tabla de strings */
+    long long stringsSize; /*!< Tamaño de la tabla de strings */
+    long long usersOffset; /*!< Inicio de los registros de usuarios */
+    long long interestsOffset; /*!< Inicio de los intereses */
+    long long edgeOffsetsOffset; /*!< Inicio de los inicios de adyacencia (numNodes + 1 int) */
+    long long edgeTargetsOffset; /*!< Inicio de los ids destino (numEdges int) */
+    long long edgeWeightsOffset; /*!< Inicio de los pesos (numEdges double) */
+    long long postsOffset; /*!< Inicio de los registros de posts */
+    long long usersByIdOffset; /*!< Inicio de la posición del registro de cada id (numNodes int, -1 si no está en uso) */
+    long long usernameIndexOffset; /*!< Inicio del índice de nombres de usuario */
+    long long usernameIndexSize; /*!< Casillas del índice de nombres de usuario (potencia de 2) */
+    long long followerOffsetsOffset; /*!< Inicio de los inicios de adyacencia de seguidores (numNodes + 1 int) */
+    long long followerSourcesOffset; /*!< Inicio de los ids de seguidores (numEdges int) */
+    long long followerWeightsOffset; /*!< Inicio de los pesos de seguidores (numEdges double) */
+};
+
+/**
+ * @struct _snapshotUser
+ * @brief Registro de un usuario en el snapshot
+ * @note Los strings son posiciones en la tabla de strings, -1 si no tiene
+ */
+struct _snapshotUser{
+    int id; /*!< Id del usuario */
+    int popularity; /*!< Popularidad */
+    float friendliness; /*!< Amigabilidad */
+    int numPosts; /*!< Cantidad de posts */
+    long long firstPost; /*!< Índice de su primer post en la sección de posts */
+    long long username; /*!< Nombre de usuario */
+    long long password; /*!< Contraseña */
+    long long name; /*!< Nombre */
+    long long category; /*!< Categoría de amigabilidad */
+};
+
+/**
+ * @struct _snapshotPost
+ * @brief Registro de un post en el snapshot
+ * @note Los posts de cada usuario están seguidos y en el mismo orden que su lista
+ */
+struct _snapshotPost{
+    int id; /*!< Id del post */
+    int year; /*!< tm_year de la fecha */
+    int month; /*!< tm_mon de la fecha */
+    int day; /*!< tm_mday de la fecha */
+    int hour; /*!< tm_hour de la fecha */
+    int minute; /*!< tm_min de la fecha */
+    int second; /*!< tm_sec de la fecha */
+    int weekDay; /*!< tm_wday de la fecha */
+    int yearDay; /*!< tm_yday de la fecha */
+    int isDst; /*!< tm_isdst de la fecha */
+    long long content; /*!< Contenido en la tabla de strings, -1 si no tiene */
+};
+
+/**
+ * @struct _walHeader
+ * @brief Encabezado del WAL
+ * @note Si la generación no coincide con la del snapshot, el WAL ya fue incorporado y se descarta
+ */
+struct _walHeader{
+    char magic[8]; /*!< WAL_MAGIC */
+    int generation; /*!< Generación del snapshot sobre la que se aplican los registros */
+    int reserved; /*!< Sin uso */
+};
+
+/**
+ * @struct _walRecord
+ * @brief Encabezado de un registro del WAL, seguido de length bytes de datos
+ * @note Datos según el tipo: WAL_FOLLOW y WAL_UNFOLLOW el id seguido (int); WAL_POST un SnapshotPost y el contenido;
+ *       WAL_EDIT_* el nuevo valor; WAL_REGISTER usuario, contraseña, nombre y sus intereses; WAL_DELETE nada.
+ *       Los strings van terminados en '\0'
+ */
+struct _walRecord{
+    int type; /*!< Tipo de registro (WAL_FOLLOW, WAL_POST, ...) */
+    int userId; /*!< Id del usuario que hace el cambio */
+    int length; /*!< Bytes de datos después del encabezado */
+    unsigned int checksum; /*!< Hash de los datos, para descartar un registro escrito a medias */
+};
 
 /* FUNCIONES DE CARGA Y GUARDADO DE LA BASE DE DATOS */
 void create_database_dir(void);
+int lock_database(int exclusive);
 void save_user_data(User user, GlobalInterests globalInterests);
+void save_dirty_users(Graph graph, GlobalInterests globalInterests);
+void defer_user_saves(int defer);
 void save_all_users(Graph graph, GlobalInterests globalInterests);
-void clear_database(Graph graph);
+void clear_database(void);
 int database_exists_and_not_empty(void);
 void load_all_users(PtrToHashTable table, Graph graph, GlobalInterests globalInterests);
 User load_user_from_file(const char *filename, PtrToHashTable table, Graph graph, GlobalInterests globalInterests);
 void load_database(PtrToHashTable table, Graph graph, GlobalInterests globalInterests);
-void load_connections(PtrToHashTable table, GlobalInterests globalInterests);
+void open_database(PtrToHashTable table, Graph graph, GlobalInterests globalInterests);
+void flush_database(Graph graph, GlobalInterests globalInterests);
+
+/* FUNCIONES DEL SNAPSHOT */
+int write_snapshot(Graph graph, GlobalInterests globalInterests, const char *path);
+void load_snapshot(PtrToHashTable table, Graph graph, GlobalInterests globalInterests, const char *path);
+void migrate_database(Graph graph, GlobalInterests globalInterests);
+void free_database_memory(void *pointer);
+void close_database(void);
+User load_user_on_demand(const char *username, User user);
+
+/* FUNCIONES DEL WAL */
+void append_wal_record(int type, User user, const void *data, int length);
+void append_wal_post(User user, PtrToPostNode post);
+void append_wal_register(User user, GlobalInterests globalInterests);
+int write_wal(void);
+void replay_wal(PtrToHashTable table, Graph graph, GlobalInterests globalInterests);
+int fold_wal_into_snapshot(Graph graph, GlobalInterests globalInterests);
+void compact_database(Graph graph, GlobalInterests globalInterests);
 
 /* FUNCIONES DE SESIONES */
-void login(PtrToHashTable graph);
+int login(PtrToHashTable graph);
 void logout(void);
 User current_session(PtrToHashTable graph);
-void register_user(PtrToHashTable table, Graph graph, GlobalInterests globalInterests);
-void write_post(User user, GlobalInterests globalInterests);
-void follow(User user, char* follow, GlobalInterests globalInterests, PtrToHashTable table);
-void unfollow(User user, char* follow, GlobalInterests globalInterests, PtrToHashTable table);
-void delete_account(User user);
-void edit_account(User user, GlobalInterests globalInterests, PtrToHashTable table);
+int register_user(PtrToHashTable table, Graph graph, GlobalInterests globalInterests);
+int write_post(User user, GlobalInterests globalInterests);
+int follow(User user, char* follow, GlobalInterests globalInterests, PtrToHashTable table);
+int unfollow(User user, char* follow, GlobalInterests globalInterests, PtrToHashTable table);
+void delete_account(User user, PtrToHashTable table, Graph graph);
+int edit_account(User user, GlobalInterests globalInterests, PtrToHashTable table);
 void generate_database(int quantity, PtrToHashTable table, Graph graph, GlobalInterests globalInterests);
 
 #endif
@@ -18,6 +18,7 @@
 #include <math.h>
 #include <string.h>
 #include <limits.h>
+#include <stdint.h>
 
 #include "users.h"
 
@@ -29,17 +30,78 @@ typedef struct _globalInterests GlobalInterests;
 /* -------------------------------------------- */
 
 typedef struct _edge *Edge;
+typedef struct _adjacency *Adjacency;
 typedef PtrToUser GraphList;
 typedef struct _graph *Graph;
+typedef struct _csrGraph *CsrGraph;
+typedef struct _interestPostings InterestPostings;
+typedef struct _interestCandidate InterestCandidate;
+
+/**
+ * @def GRAPH_INITIAL_ID_CAPACITY
+ * @brief Capacidad inicial del arreglo de usuarios indexado por id
+ */
+#define GRAPH_INITIAL_ID_CAPACITY 64
+
+/**
+ * @def GRAPH_MAX_ID_GAP
+ * @brief Distancia máxima aceptada entre un id guardado y el siguiente id libre
+ * @note Los ids mayores se consideran heredados de versiones antiguas (hash del usuario) y se reasignan
+ */
+#define GRAPH_MAX_ID_GAP (1 << 20)
+
+/**
+ * @def ADJACENCY_INDEX_THRESHOLD
+ * @brief Cantidad de aristas desde la que una adyacencia se indexa con una tabla hash; con menos se recorre el arreglo
+ */
+#define ADJACENCY_INDEX_THRESHOLD 8
+
+/**
+ * @def ADJACENCY_INITIAL_CAPACITY
+ * @brief Capacidad inicial del arreglo de aristas de una adyacencia
+ */
+#define ADJACENCY_INITIAL_CAPACITY 4
 
 /**
  * @struct _edge 
- * @brief Estructura que representa una lista de arista de un usuario perteneciente al grafo
+ * @brief Estructura que representa una arista de un usuario perteneciente al grafo
  */
 struct _edge{
     User dest; /*!< Usuario destino */
     double weight; /*!< Peso de la arista */
-    Edge next; /*!< Siguiente en la lista de aristas */
+};
+
+/**
+ * @struct _adjacency
+ * @brief Aristas de un usuario (seguidos o seguidores) en un arreglo, con un índice hash destino -> posición
+ * @note El índice usa direccionamiento abierto con sondeo lineal y solo existe desde ADJACENCY_INDEX_THRESHOLD aristas,
+ *       así buscar, añadir y quitar una arista es O(1) amortizado. Quitar una arista mueve la última a su lugar
+ */
+struct _adjacency{
+    Edge edges; /*!< Aristas, en el orden en que se añadieron salvo las movidas al quitar otra */
+    int size; /*!< Cantidad de aristas */
+    int capacity; /*!< Capacidad del arreglo edges */
+    int *index; /*!< Posición en edges de cada destino, -1 si la casilla está vacía (NULL si no hay índice) */
+    int indexCapacity; /*!< Casillas del índice, potencia de 2 */
+};
+
+/**
+ * @struct _interestPostings
+ * @brief Lista ordenada de ids de los usuarios que tienen un interés (índice invertido interés -> usuarios)
+ */
+struct _interestPostings{
+    int *userIds; /*!< Ids de usuario en orden creciente */
+    int size; /*!< Cantidad de usuarios en la lista */
+    int capacity; /*!< Capacidad del arreglo userIds */
+};
+
+/**
+ * @struct _interestCandidate
+ * @brief Usuario que comparte al menos un interés con otro, junto a la cantidad de intereses en común
+ */
+struct _interestCandidate{
+    int userId; /*!< Id del usuario candidato */
+    int overlap; /*!< Cantidad de intereses en común */
 };
 
 /**
@@ -49,21 +111,68 @@ struct _edge{
 struct _graph{
     GraphList graphUsersList; /*!< Lista de usuarios en el grafo */
     int usersNumber; /*!< Numero de usuarios en el grafo */
+    User *usersById; /*!< Usuarios indexados por id (NULL si el id no está en uso) */
+    int idCapacity; /*!< Capacidad del arreglo usersById */
+    int nextId; /*!< Siguiente id libre, cota superior de todos los ids en uso */
+    InterestPostings *interestIndex; /*!< Índice invertido: usuarios de cada interés global */
+    int numIndexedInterests; /*!< Cantidad de intereses en interestIndex */
+    int *overlapCounts; /*!< Contador por id reutilizado por search_interest_candidates, siempre en 0 entre búsquedas */
+    int overlapCapacity; /*!< Capacidad de overlapCounts */
+    unsigned int interestsVersion; /*!< Aumenta con cada cambio de interestIndex, así se sabe si lo calculado a partir de él quedó viejo */
+    CsrGraph csr; /*!< Copia CSR de solo lectura para los recorridos (NULL hasta pedirla), @see get_csr_graph */
+    unsigned int csrVersion; /*!< Versión de las aristas con que se construyó csr */
+};
+
+/**
+ * @struct _csrGraph
+ * @brief Copia de solo lectura del grafo en formato CSR (compressed sparse row)
+ * @note Los vecinos del usuario con id i están en las posiciones [offsets[i], offsets[i+1]) de los arreglos de destinos y pesos.
+ *       Las sugerencias de amigos de amigos la recorren y el snapshot la escribe tal cual; las adyacencias de cada usuario
+ *       siguen siendo la estructura que se modifica
+ */
+struct _csrGraph{
+    int numNodes; /*!< Cantidad de ids (igual a nextId del grafo al momento de construirlo) */
+    int numEdges; /*!< Cantidad de aristas de seguidos */
+    int numInEdges; /*!< Cantidad de aristas de seguidores (igual a numEdges si el grafo es consistente) */
+    int *outOffsets; /*!< Inicio de los seguidos de cada id (numNodes + 1 elementos) */
+    int *outTargets; /*!< Ids de los usuarios seguidos */
+    double *outWeights; /*!< Pesos de las aristas de seguidos */
+    int *inOffsets; /*!< Inicio de los seguidores de cada id (numNodes + 1 elementos) */
+    int *inTargets; /*!< Ids de los seguidores */
+    double *inWeights; /*!< Pesos de las aristas de seguidores */
 };
 
 /* FUNCIONES DE EDGE */
-Edge init_empty_edge(void);
-Edge search_previous_in_edge(Edge edge, User user);
-void add_edge(User user1, User user2, GlobalInterests globalInterests);
-void remove_edge(User user1, User user2);
+Adjacency init_adjacency(void);
+void free_adjacency(Adjacency adjacency);
+Edge search_edge(Adjacency adjacency, User user);
+int add_edge(User user1, User user2, GlobalInterests globalInterests);
+int add_edge_with_weight(User user1, User user2, double weight);
+int remove_edge(User user1, User user2);
 void free_all_edges(User user);
 
 /* FUNCIONES DE GRAPH*/
 Graph initialize_graph(void);
 void add_user_to_graph(Graph graph, User user);
 void remove_user_from_graph(Graph graph, User user);
+void clear_graph_users(Graph graph);
+void assign_user_id(Graph graph, User user, int id);
+void reserve_graph_ids(Graph graph, int numNodes);
+User get_user_by_id(Graph graph, int id);
 void free_graph(Graph graph);
 
+/* FUNCIONES DEL ÍNDICE DE INTERESES */
+void index_user_interest(Graph graph, User user, int interestId);
+void index_user_interests(Graph graph, User user, GlobalInterests globalInterests);
+void unindex_user_interests(Graph graph, User user);
+void clear_interest_index(Graph graph);
+int search_interest_candidates(Graph graph, User user, InterestCandidate **candidates);
+
+/* FUNCIONES DE CSR */
+CsrGraph build_csr_graph(Graph graph);
+void free_csr_graph(CsrGraph csr);
+CsrGraph get_csr_graph(Graph graph);
+
 /* FUNCIONES DE AFINIDAD*/
 double calculate_affinity(Graph graph, int user1_id, int user2_id);
 
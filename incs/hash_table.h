@@ -16,8 +16,19 @@
 #include <stdio.h>
 #include <string.h>
 #include "utilities.h"
+#include "allocator.h"
 
-#define HASH_TABLE_SIZE 100
+/**
+ * @def HASH_TABLE_INITIAL_CAPACITY
+ * @brief Capacidad inicial de la tabla hash (debe ser potencia de 2)
+ */
+#define HASH_TABLE_INITIAL_CAPACITY 64
+
+/**
+ * @def HASH_TABLE_MAX_LOAD
+ * @brief Factor de carga máximo antes de duplicar la capacidad de la tabla
+ */
+#define HASH_TABLE_MAX_LOAD 0.85
 
 typedef struct _hashnode Hashnode;
 typedef struct _hashtable HashTable;
@@ -25,21 +36,25 @@ typedef HashTable* PtrToHashTable;
 
 /**
  * @struct _hashnode
- * @brief Nodo individual en la tabla hash
- * @note Almacena un par clave-valor
+ * @brief Casilla individual en la tabla hash
+ * @note Almacena un par clave-valor junto al hash completo de la clave, que se compara antes que la clave para evitar llamadas a strcmp
  */
 struct _hashnode {
     char *key; /*!< Clave única asociada al dato */
     void *data; /*!< Puntero genérico a los datos */
-    Hashnode *next; /*!< Puntero al siguiente nodo (en caso de colisión) */
+    unsigned int hash; /*!< Hash completo (32 bits) de la clave */
+    unsigned int distance; /*!< Distancia a la casilla ideal + 1 (0 si la casilla está vacía) */
 };
 
 /**
  * @struct _hashtable
  * @brief Estructura principal de la tabla hash
+ * @note Direccionamiento abierto con sondeo lineal Robin Hood, crece al superar @ref HASH_TABLE_MAX_LOAD
  */
 struct _hashtable {
-    Hashnode *buckets[HASH_TABLE_SIZE]; /*!< Array de nodos (buckets) */
+    Hashnode *slots; /*!< Arreglo de casillas */
+    unsigned int capacity; /*!< Número de casillas (potencia de 2) */
+    unsigned int count; /*!< Número de elementos almacenados */
 };
 
 /* Funciones principales para gestionar tablas hash */
@@ -47,6 +62,7 @@ HashTable* create_hash_table(void);
 int insert_into_hash_table(HashTable *table, const char *key, void *data);
 void *search_in_hash_table(HashTable *table, const char *key);
 int delete_from_hash_table(HashTable *table, char *key);
+void clear_hash_table(HashTable *table);
 void free_hash_table(HashTable *table);
 
 #endif
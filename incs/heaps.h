@@ -15,6 +15,8 @@
 
 typedef struct _heap heap;
 typedef struct _post post;
+typedef struct _indexedHeap IndexedHeap;
+typedef struct _topK TopK;
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -22,51 +24,142 @@ typedef struct _post post;
 #include "users.h"
 #include "hash_table.h"
 #include "graph.h"
+#include "similarity.h"
+#include "ranking.h"
 
 /**
- * @def MAX_HEAP_SIZE
- * @brief Cantidad máxima de elementos en el heap
+ * @def HEAP_INITIAL_CAPACITY
+ * @brief Capacidad del arreglo del heap al insertar el primer elemento; luego se duplica cada vez que se llena
  */
-#define MAX_HEAP_SIZE 100000
+#define HEAP_INITIAL_CAPACITY 16
+
+/**
+ * @def FEED_TOP_K
+ * @brief Cantidad de publicaciones que se guardan para el feed si no se indica otra (@see TopK)
+ */
+#define FEED_TOP_K 100
+
+/**
+ * @def SUGGESTIONS_TOP_K
+ * @brief Cantidad de sugerencias por intereses que se guardan si no se indica otra (@see TopK)
+ */
+#define SUGGESTIONS_TOP_K 20
+
+/**
+ * @def INDEXED_HEAP_ARITY
+ * @brief Cantidad de hijos por nodo del heap indexado usado por Dijkstra
+ */
+#define INDEXED_HEAP_ARITY 4
+
+/**
+ * @def SUGGESTIONS_MAX_RESULTS
+ * @brief Cantidad de sugerencias de amigos de amigos que se buscan
+ */
+#define SUGGESTIONS_MAX_RESULTS 10
+
+/**
+ * @def SUGGESTIONS_MAX_HOPS
+ * @brief Cantidad máxima de saltos desde el usuario para las sugerencias de amigos de amigos
+ * @note Es exacta: se sugiere todo usuario alcanzable con a lo sumo esta cantidad de saltos, aunque su camino más corto tenga más
+ */
+#define SUGGESTIONS_MAX_HOPS 3
+
+/**
+ * @def SUGGESTIONS_MAX_DISTANCE
+ * @brief Distancia máxima (suma de distancias de jaccard) para las sugerencias de amigos de amigos
+ */
+#define SUGGESTIONS_MAX_DISTANCE 3.0
+
+/**
+ * @def FRONTIER_INITIAL_CAPACITY
+ * @brief Usuarios alcanzados que caben al iniciar @see dijkstra_bounded; luego la capacidad se duplica cada vez que se llena
+ */
+#define FRONTIER_INITIAL_CAPACITY 64
 
 /**
  * @struct _post
- * @brief Estructura que almacena los datos de una publicación
+ * @brief Estructura que referencia una publicación o una sugerencia en el heap
+ * @note No copia textos: el nombre y el contenido se leen del usuario y de la publicación al mostrarlos, así que el heap
+ *       debe vaciarse antes de modificar la red (se llena y se muestra dentro de un mismo comando)
  */
 struct _post {
-    char* user_name;  /*!< Nombre de usuario */
-    char* name;       /*!< Nombre real */
-    double priority;  /*!< Prioridad (por ejemplo, basado en intereses del usuario) */
-    char* content;    /*!< Contenido de la publicación */
+    User author;         /*!< Autor de la publicación o usuario sugerido */
+    PtrToPostNode node;  /*!< Publicación (NULL en las sugerencias de usuarios) */
+    double priority;     /*!< Prioridad (por ejemplo, basado en intereses del usuario) */
 };
 
 /**
  * @struct _heap
- * @brief Estructura para el heap
+ * @brief Estructura para el heap de mínimos y máximos: la raíz es la menor prioridad y uno de sus hijos la mayor
+ * @note Iniciar con @see init_heap y liberar con @see free_heap. El arreglo crece según se necesita, sin límite de elementos
  */
 struct _heap {
-    post posts[MAX_HEAP_SIZE]; /*!< Arreglo de publicaciones y sugerencias, se trabaja como arreglo por que en este tipo de casos es más eficiente que un arreglo dinámico */
+    post* posts; /*!< Arreglo de publicaciones y sugerencias (NULL hasta insertar el primer elemento) */
     int size; /*!< Número de elementos en el heap */
+    int capacity; /*!< Capacidad del arreglo posts */
 };
 
+/**
+ * @struct _topK
+ * @brief Acumulador de los K mejores elementos: heap de tamaño fijo cuya raíz es el peor de los que se guardan
+ * @note Un candidato que no supera a la raíz se descarta sin copiar nada, así recorrer N candidatos cuesta O(N log K) y
+ *       solo se guardan K. Con keepLowest se guardan las K prioridades menores (por ejemplo distancias de jaccard)
+ */
+struct _topK {
+    post* items; /*!< Elementos guardados, ordenados como heap con el peor en la raíz */
+    int size; /*!< Número de elementos guardados */
+    int capacity; /*!< Capacidad del arreglo items, crece hasta k según se necesita */
+    int k; /*!< Cantidad máxima de elementos */
+    int keepLowest; /*!< 1 para guardar las prioridades menores, 0 para las mayores */
+};
+
+/**
+ * @struct _indexedHeap
+ * @brief Heap de mínimos d-ario sobre ids de usuario, con mapa de posiciones para disminuir claves en O(log n)
+ */
+struct _indexedHeap {
+    int *nodes; /*!< Ids de usuario ordenados como heap */
+    int *position; /*!< Posición + 1 de cada id en nodes (0 si no está en el heap) */
+    double *keys; /*!< Clave (distancia) de cada id */
+    int size; /*!< Número de elementos en el heap */
+    int capacity; /*!< Cantidad de ids que admite el heap */
+};
 
 //Funciones para gestionar propiedades heaps
+void init_heap(heap* h, int capacity); // Inicializa un heap vacío con espacio para capacity elementos (0 para no reservar)
+void reserve_heap(heap* h, int capacity); // Asegura espacio para capacity elementos sin volver a reservar
 void heapify_up(heap* h, int index); // Función para asegurar que el heap mantenga la propiedad (heapify_up)
-void heapify_down(heap* h, int index); // Función para hacer heapify_down (restaurar la propiedad después de extraer el máximo)
+void heapify_down(heap* h, int index); // Función para hacer heapify_down (restaurar la propiedad después de extraer el máximo o el mínimo)
 void extract_max(heap* h, int option); // Función para extraer el máximo (el nodo más relevante)
 void extract_min(heap* h, int option); // Función para extraer el mínimo (el nodo menos relevante)
+post* peek_max(heap* h); // Función para consultar el máximo sin extraerlo
+post* peek_min(heap* h); // Función para consultar el mínimo sin extraerlo
 void print_heap(heap* h); // Función para imprimir el heap
-void free_heap(heap* h); // Función para liberar memoria del heap
+void free_heap(heap* h); // Función para liberar memoria del heap y dejarlo vacío
+
+// funciones para gestionar los K mejores candidatos
+void init_top_k(TopK* t, int k, int keepLowest); // Inicializa un acumulador vacío de los k mejores
+int top_k_accepts(const TopK* t, double priority); // Indica si un candidato con esa prioridad entraría en el acumulador
+void top_k_insert(TopK* t, User author, PtrToPostNode node, double priority); // Inserta un candidato si está entre los k mejores
+void top_k_to_heap(TopK* t, heap* h); // Mueve los elementos del acumulador al heap
+void free_top_k(TopK* t); // Libera la memoria del acumulador
 
 // funciones para gestionar publicaciones y sugerencias
-void insert_new_item(heap* h, const char* user_name, double priority, const char* content); // Función para insertar una publicación en el heap
+void insert_new_item(heap* h, User author, PtrToPostNode node, double priority); // Función para insertar una publicación en el heap
 void watch_posts(heap* h); // Función para ver publicaciones del heap
 void watch_suggestions_friends_of_friends(heap* h); // Función para ver sugerencias del heap
-void watch_suggestions_by_interests(heap* h); // Función para ver sugerencias del heap
-void search_posts_in_my_follows(heap* h, User currentUser); // Función para buscar publicaciones de mis seguidos para colocar en el heap
-void search_posts_by_interests(heap* h, PtrToHashTable table, GlobalInterests globalInterestsTable, User currentUser); // Función para buscar publicaciones de interes del usuario para colocar en el heap
-void search_new_possible_friends(heap* h, PtrToHashTable table, GlobalInterests globalInterestsTable, User currentUser); // Función para buscar usuarios con intereses similares a los de un usuario
-void dijkstra(heap* h, Graph graph, User source); // Calcula la distancia de un user a otro en un grafo
-int dijkstra_table_index(Graph graph, User source);
+void watch_suggestions_by_interests(heap* h, User currentUser, GlobalInterests globalInterestsTable); // Función para ver sugerencias del heap
+void search_posts_in_my_follows(FeedCandidates* candidates, User currentUser); // Función para buscar publicaciones de mis seguidos candidatas al feed
+void search_posts_by_interests(FeedCandidates* candidates, Graph graph, GlobalInterests globalInterestsTable, User currentUser); // Función para buscar publicaciones de interes del usuario candidatas al feed
+void search_new_possible_friends(TopK* suggestions, Graph graph, LshIndex lsh, GlobalInterests globalInterestsTable, User currentUser); // Función para buscar usuarios con intereses similares a los de un usuario
+int search_precomputed_possible_friends(TopK* suggestions, Graph graph, GlobalInterests globalInterestsTable, User currentUser); // Función para buscar usuarios similares en la tabla precalculada
+// heap indexado para Dijkstra
+void init_indexed_heap(IndexedHeap* h, int capacity); // Inicializa un heap indexado vacío para ids en [0, capacity)
+void reserve_indexed_heap(IndexedHeap* h, int capacity); // Amplía el heap indexado para ids en [0, capacity)
+void free_indexed_heap(IndexedHeap* h); // Libera la memoria del heap indexado
+void indexed_heap_push_or_decrease(IndexedHeap* h, int node, double key); // Inserta un id o disminuye su clave
+int indexed_heap_pop_min(IndexedHeap* h); // Extrae el id con menor clave (-1 si está vacío)
+
+void dijkstra_bounded(heap* h, CsrGraph csr, Graph graph, User source, int k, int maxHops, double maxDistance); // Busca los k usuarios no seguidos más cercanos dentro de un radio
 
 #endif
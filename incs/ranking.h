@@ -0,0 +1,111 @@
+/**
+ * @file ranking.h
+ * @brief Cabecera para ranking.c
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#ifndef RANKING_H
+#define RANKING_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "users.h"
+
+/* typedefs para evitar errores de compilación */
+typedef struct _user _User;
+typedef _User *User;
+typedef struct _postNode PostNode;
+typedef PostNode *PtrToPostNode;
+typedef struct _topK TopK;
+/* -------------------------------------------- */
+
+typedef struct _feedWeights FeedWeights;
+typedef struct _feedCandidates FeedCandidates;
+
+/**
+ * @def FEED_WEIGHTS_FILE
+ * @brief Archivo opcional con los pesos del puntaje del feed, una línea '<señal> <valor>' por peso
+ * @note Las señales son recencia, afinidad, popularidad, seguidores, seguido y vida_media (en horas); las que no aparecen
+ *       usan su valor por defecto
+ */
+#define FEED_WEIGHTS_FILE "feed_weights"
+
+/**
+ * @def FEED_HALF_LIFE_HOURS
+ * @brief Horas tras las que la recencia de una publicación vale la mitad que al publicarla
+ */
+#define FEED_HALF_LIFE_HOURS 24.0
+
+/**
+ * @def FEED_POPULARITY_SCALE
+ * @brief Popularidad del autor con la que su señal vale 0.5 (la señal es p / (p + escala), entre 0 y 1)
+ */
+#define FEED_POPULARITY_SCALE 10.0
+
+/**
+ * @def FEED_FOLLOWERS_SCALE
+ * @brief Cantidad de seguidores del autor con la que su señal vale 0.5 (la señal es s / (s + escala), entre 0 y 1)
+ */
+#define FEED_FOLLOWERS_SCALE 50.0
+
+/**
+ * @def FEED_SCORE_BLOCK
+ * @brief Cantidad de candidatos del feed que se puntúan juntos antes de pasarlos al acumulador de los mejores
+ */
+#define FEED_SCORE_BLOCK 256
+
+/**
+ * @struct _feedWeights
+ * @brief Pesos de cada señal en el puntaje de una publicación del feed
+ */
+struct _feedWeights{
+    double recency; /*!< Peso de la recencia de la publicación */
+    double affinity; /*!< Peso de la afinidad con el autor (1 - distancia de jaccard) */
+    double popularity; /*!< Peso de la popularidad del autor */
+    double followers; /*!< Peso de la cantidad de seguidores del autor */
+    double following; /*!< Peso de que el usuario siga al autor */
+    double halfLifeHours; /*!< Horas tras las que la recencia vale la mitad */
+};
+
+/**
+ * @struct _feedCandidates
+ * @brief Bloque de publicaciones candidatas al feed con sus señales en arreglos paralelos, para puntuarlas juntas
+ * @note Las señales se guardan sin normalizar y se combinan en un solo recorrido sin saltos, que el compilador puede
+ *       vectorizar. Cada bloque lleno se puntúa y se pasa al acumulador, así la memoria es O(K + bloque) y no crece con la
+ *       cantidad de candidatos
+ */
+struct _feedCandidates{
+    User *authors; /*!< Autor de cada publicación */
+    PtrToPostNode *posts; /*!< Publicación */
+    double *ageHours; /*!< Horas desde que se publicó */
+    double *distance; /*!< Distancia de jaccard entre el usuario y el autor */
+    double *popularity; /*!< Popularidad del autor */
+    double *followers; /*!< Cantidad de seguidores del autor */
+    double *followed; /*!< 1 si el usuario sigue al autor, 0 si no */
+    double *scores; /*!< Puntaje de cada publicación */
+    int size; /*!< Cantidad de candidatos del bloque (como mucho @see FEED_SCORE_BLOCK) */
+    TopK *feed; /*!< Acumulador de las mejores publicaciones, recibe cada bloque puntuado */
+    FeedWeights weights; /*!< Pesos de cada señal */
+    long long now; /*!< Fecha actual en segundos, contada igual que las fechas de las publicaciones */
+};
+
+/* FUNCIONES DE PESOS */
+FeedWeights default_feed_weights(void);
+FeedWeights load_feed_weights(const char *path);
+
+/* FUNCIONES DE CANDIDATOS */
+void init_feed_candidates(FeedCandidates *candidates, TopK *feed, FeedWeights weights);
+void add_author_posts(FeedCandidates *candidates, User author, double distance, int followed);
+void flush_feed_candidates(FeedCandidates *candidates);
+void free_feed_candidates(FeedCandidates *candidates);
+
+#endif
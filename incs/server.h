@@ -0,0 +1,90 @@
+/**
+ * @file server.h
+ * @brief Cabecera para server.c
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include "commands.h"
+
+/* typedefs para evitar errores de compilación */
+typedef struct _globalInterests GlobalInterests;
+typedef struct _graph *Graph;
+typedef struct _hashtable HashTable;
+typedef HashTable* PtrToHashTable;
+/* -------------------------------------------- */
+
+typedef struct _requestHeader RequestHeader;
+typedef struct _responseHeader ResponseHeader;
+
+/**
+ * @def SERVER_SOCKET_FILE
+ * @brief Socket Unix del servidor, en el directorio desde donde se ejecuta el programa (junto a 'database' y 'current.dat')
+ */
+#define SERVER_SOCKET_FILE "devgraph.sock"
+
+/**
+ * @def SERVER_MAX_REQUEST
+ * @brief Tamaño máximo de los argumentos más la entrada de una solicitud
+ */
+#define SERVER_MAX_REQUEST (16 * 1024 * 1024)
+
+/**
+ * @def SERVER_FLUSH_INTERVAL_MS
+ * @brief Milisegundos máximos que los cambios quedan en memoria antes de escribirse a la base de datos
+ */
+#define SERVER_FLUSH_INTERVAL_MS 1000
+
+/**
+ * @def SERVER_REQUEST_TIMEOUT_MS
+ * @brief Milisegundos que el servidor espera una solicitud completa (o que el cliente lea la respuesta) antes de cerrar la conexión
+ */
+#define SERVER_REQUEST_TIMEOUT_MS 5000
+
+/**
+ * @struct _requestHeader
+ * @brief Encabezado de una solicitud al servidor
+ * @note Le siguen argsLength bytes con argc argumentos terminados en '\0' (como argv, incluido el nombre del programa)
+ *       y luego inputLength bytes que el comando lee como su entrada estándar
+ */
+struct _requestHeader{
+    unsigned int argc; /*!< Cantidad de argumentos */
+    unsigned int argsLength; /*!< Bytes de argumentos */
+    unsigned int inputLength; /*!< Bytes de entrada */
+};
+
+/**
+ * @struct _responseHeader
+ * @brief Encabezado de la respuesta del servidor, seguido de outputLength bytes con la salida del comando
+ */
+struct _responseHeader{
+    int status; /*!< COMMAND_OK, COMMAND_ERROR o COMMAND_NO_SESSION */
+    unsigned int outputLength; /*!< Bytes de salida */
+};
+
+/* FUNCIONES DEL SERVIDOR Y CLIENTE */
+void run_server(PtrToHashTable table, Graph graph, GlobalInterests globalInterests);
+int run_client(int argc, char *argv[]);
+
+#endif
@@ -0,0 +1,117 @@
+/**
+ * @file similarity.h
+ * @brief Cabecera para similarity.c
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#ifndef SIMILARITY_H
+#define SIMILARITY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "users.h"
+#include "graph.h"
+
+/* typedefs para evitar errores de compilación */
+typedef struct _user _User;
+typedef _User *User;
+typedef struct _globalInterests GlobalInterests;
+typedef struct _graph *Graph;
+/* -------------------------------------------- */
+
+typedef struct _lshEntry LshEntry;
+typedef struct _lshIndex *LshIndex;
+
+/**
+ * @def MINHASH_NUM_HASHES
+ * @brief Cantidad de funciones hash de la firma MinHash de cada usuario
+ */
+#define MINHASH_NUM_HASHES 48
+
+/**
+ * @def LSH_BANDS
+ * @brief Cantidad de bandas en que se divide la firma MinHash
+ * @note Con b bandas de r filas, dos usuarios con similitud s son candidatos con probabilidad 1 - (1 - s^r)^b.
+ *       Más bandas aumentan el recall y la cantidad de candidatos; más filas lo reducen.
+ */
+#define LSH_BANDS 16
+
+/**
+ * @def LSH_ROWS
+ * @brief Cantidad de valores de la firma por banda
+ */
+#define LSH_ROWS (MINHASH_NUM_HASHES / LSH_BANDS)
+
+/**
+ * @def RECALL_MAX_USERS
+ * @brief Cantidad máxima de usuarios consultados al medir el recall de LSH
+ */
+#define RECALL_MAX_USERS 1000
+
+/**
+ * @def SIMILARITY_TOP_K
+ * @brief Cantidad de usuarios más similares que se precalculan por usuario
+ * @note Debe ser al menos SUGGESTIONS_TOP_K para que las sugerencias por defecto salgan de la tabla; si se piden más, se
+ *       buscan sin ella (@see search_precomputed_possible_friends)
+ */
+#define SIMILARITY_TOP_K 20
+
+/**
+ * @def SIMILARITY_FILE
+ * @brief Archivo donde se guardan los usuarios más similares precalculados
+ */
+#define SIMILARITY_FILE "similarity.dat"
+
+/**
+ * @def SIMILARITY_MAX_THREADS
+ * @brief Cantidad máxima de hilos del cálculo de similitudes
+ */
+#define SIMILARITY_MAX_THREADS 64
+
+/**
+ * @struct _lshEntry
+ * @brief Par (hash de banda, usuario) de un bucket de LSH
+ */
+struct _lshEntry{
+    unsigned long long key; /*!< Hash de la banda de la firma */
+    int userId; /*!< Id del usuario */
+};
+
+/**
+ * @struct _lshIndex
+ * @brief Firmas MinHash de todos los usuarios y sus buckets de LSH por banda
+ */
+struct _lshIndex{
+    int numNodes; /*!< Cantidad de ids cubiertos (nextId del grafo al construirlo) */
+    unsigned int *signatures; /*!< Firma de cada id, MINHASH_NUM_HASHES valores por id */
+    LshEntry *bands[LSH_BANDS]; /*!< Entradas de cada banda ordenadas por key */
+    int bandSize; /*!< Cantidad de entradas en cada banda */
+    int numWords; /*!< Palabras del conjunto de intereses de cada usuario */
+    Graph graph; /*!< Grafo con el que se construyó */
+    unsigned int interestsVersion; /*!< interestsVersion del grafo al construirlo, @see cached_lsh_index */
+};
+
+/* FUNCIONES DE MINHASH Y LSH */
+void minhash_signature(InterestTable interests, GlobalInterests globalInterests, unsigned int *signature);
+LshIndex build_lsh_index(Graph graph, GlobalInterests globalInterests);
+LshIndex cached_lsh_index(Graph graph, GlobalInterests globalInterests);
+void free_lsh_index(LshIndex lsh);
+int lsh_candidates(LshIndex lsh, Graph graph, User user, int **candidates);
+void measure_lsh_recall(Graph graph, GlobalInterests globalInterests);
+
+/* FUNCIONES DE SIMILITUDES PRECALCULADAS */
+void compute_similarity_join(Graph graph, GlobalInterests globalInterests, const char *path);
+int read_similar_users(const char *path, Graph graph, User user, int *ids, float *similarities);
+
+#endif
@@ -25,6 +25,7 @@
 #include "hash_table.h"
 #include "graph.h"
 #include "database.h"
+#include "allocator.h"
 
 /*usuarios individuales*/
 typedef struct _user _User;
@@ -36,13 +37,13 @@ typedef PostNode *PtrToPostNode;
 typedef PtrToPostNode PostsPosition;
 typedef PtrToPostNode UserPosts;
 
-typedef struct _interest Interest;
-typedef Interest *InterestTable;
-typedef Interest *PtrToInterest;
+typedef unsigned long long InterestWord;
+typedef InterestWord *InterestTable;
 
 /* typedefs para evitar errores de compilación */
 typedef struct _globalInterests GlobalInterests;
 typedef struct _edge *Edge;
+typedef struct _adjacency *Adjacency;
 typedef struct _graph *Graph;
 typedef struct _hashnode Hashnode;
 typedef struct _hashtable HashTable;
@@ -54,24 +55,28 @@ typedef HashTable* PtrToHashTable;
  * @brief Estructura que almacena los datos de un usuario
  */
 struct _user{
-    int id;          /*!< id (hash) del usuario*/
+    int id;          /*!< id denso y estable del usuario, asignado por assign_user_id (posición en @ref _graph::usersById)*/
     char *username;  /*!< username*/
     char *password;  /*!< contraseña del usuario*/
     char *name;      /*!< nombre del usuario*/
     UserPosts posts; /*!< puntero a la lista de posts*/ 
     /* GRAFO */
-    Edge following;   /*!< lista de adyacencia de usuarios que sigue*/
-    Edge followers;   /*!< lista de adyacencia de usuarios que le siguen*/
+    Adjacency following;   /*!< adyacencia de usuarios que sigue*/
+    Adjacency followers;   /*!< adyacencia de usuarios que le siguen*/
     int numFollowing; /*!< número de usuarios que sigue */
     int numFollowers; /*!< número de usuarios que lo siguen */
     PtrToUser next;   /* siguiente en la lista del grafo */
     /* INTERESES Y POPULARIDAD*/
     int popularity;          /*!< popularidad del usuario */
-    InterestTable interests; /* Tabla de intereses del usuario */
+    InterestTable interests; /* Conjunto de bits de intereses del usuario */
 
     // Campos nuevos para amigabilidad
     float friendliness;  
     char *category;      
+
+    /* GUARDADO */
+    int dirty;      /*!< partes con cambios sin guardar (USER_DIRTY_*) */
+    int savedPosts; /*!< cantidad de posts que ya están guardados; los posts nuevos son los primeros posts->id - savedPosts de la lista */
 };
 
 /**
@@ -88,14 +93,20 @@ struct _postNode{
 };
 
 /**
- * @struct _interest
- * @brief Estructura que almacena un interes
+ * @def USER_DIRTY_PROFILE
+ * @brief Partes de un usuario que pueden tener cambios sin guardar: datos (data.dat), seguidos y seguidores
  */
-struct _interest{
-    char *name; /*!< Nombre del interes*/
-    int globalId; /*!< Index en la tabla de intereses globales */
-    int value; /*!< Valor del interes (0 si no la tiene, 1 si la tiene) */
-};
+#define USER_DIRTY_PROFILE 1
+#define USER_DIRTY_FOLLOWING 2
+#define USER_DIRTY_FOLLOWERS 4
+#define USER_DIRTY_ALL (USER_DIRTY_PROFILE | USER_DIRTY_FOLLOWING | USER_DIRTY_FOLLOWERS)
+
+/**
+ * @def INTEREST_WORD_BITS
+ * @brief Cantidad de intereses que caben en una palabra del conjunto de bits de intereses
+ * @note Los intereses de un usuario (InterestTable) son un conjunto de bits: el bit i indica si tiene el interés global i
+ */
+#define INTEREST_WORD_BITS 64
 
 /**
  * @struct _globalInterests
@@ -104,10 +115,12 @@ struct _interest{
 struct _globalInterests{
     char **interestsTable; /*!< Tabla de intereses globales */
     int numInterests; /*!< Número de intereses totales */
+    int numWords; /*!< Número de palabras de los conjuntos de bits de intereses */
 };
 
 // Funciones para gestionar usuarios
 User create_new_user(const char *username, const char *password, const char *name, PtrToHashTable table, Graph graph, GlobalInterests globalInterests);
+User create_user_from_data(char *username, char *password, char *name, InterestTable interests, PtrToHashTable table, Graph graph);
 void delete_user(User user, PtrToHashTable table, Graph graph);
 User search_user(char *username, PtrToHashTable table);
 void free_all_users(PtrToHashTable table, Graph graph);
@@ -132,7 +145,9 @@ GlobalInterests init_global_interests(void);
 void free_global_interests(GlobalInterests globalInterestTable);
 InterestTable init_user_interests(GlobalInterests globalInterestTable);
 void free_user_interests(InterestTable userInterests);
-void add_interest(User user, GlobalInterests globalInterestTable, int interestId);
+void add_interest(User user, Graph graph, GlobalInterests globalInterestTable, int interestId);
+void set_interest(InterestTable userInterests, int interestId);
+int has_interest(InterestTable userInterests, int interestId);
 void print_global_interests(GlobalInterests globalInterestTable);
 double edge_jaccard(User user1, User user2, GlobalInterests globalInterestTable);
 
@@ -0,0 +1,414 @@
+/**
+ * @file allocator.c
+ * @brief Pools de estructuras de tamaño fijo y arena de strings, para no reservar cada usuario, adyacencia, publicación y string
+ *        por separado con malloc
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#include "allocator.h"
+#include "users.h"
+#include "graph.h"
+
+/* bytes de una estructura o encabezado redondeados a POOL_ALIGNMENT */
+#define ALIGNED_SIZE(size) (((size) + POOL_ALIGNMENT - 1) / POOL_ALIGNMENT * POOL_ALIGNMENT)
+
+static MemoryPool pools[NUM_POOLS] = {
+    {"usuarios", ALIGNED_SIZE(sizeof(struct _user)), NULL, NULL, NULL, NULL, 0, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER},
+    {"adyacencias", ALIGNED_SIZE(sizeof(struct _adjacency)), NULL, NULL, NULL, NULL, 0, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER},
+    {"publicaciones", ALIGNED_SIZE(sizeof(struct _postNode)), NULL, NULL, NULL, NULL, 0, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER},
+};
+
+static StringArena arena = {NULL, 0, 0, NULL, ARENA_INITIAL_CHUNK, 0, 0, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER};
+
+/* primer byte de los strings de un bloque de la arena */
+#define CHUNK_DATA(chunk) ((char *)(chunk) + ALIGNED_SIZE(sizeof(ArenaChunk)))
+
+static _Thread_local AllocatorCache *threadCache = NULL; /* caché del hilo actual, NULL si usa los locks globales */
+
+/**
+ * @brief Reserva con malloc un bloque de un pool
+ *
+ * @param objectSize Bytes de cada estructura
+ * @return PoolSlab* Bloque con espacio para POOL_SLAB_OBJECTS estructuras
+ */
+static PoolSlab *new_pool_slab(size_t objectSize){
+    PoolSlab *slab = (PoolSlab *)malloc(ALIGNED_SIZE(sizeof(PoolSlab)) + objectSize * POOL_SLAB_OBJECTS);
+    if (!slab) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    return slab;
+}
+
+/**
+ * @brief Reserva un bloque nuevo para un pool
+ *
+ * @param pool Pool (con su lock tomado)
+ */
+static void add_pool_slab(MemoryPool *pool){
+    PoolSlab *slab = new_pool_slab(pool->objectSize);
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->next = (char *)slab + ALIGNED_SIZE(sizeof(PoolSlab));
+    pool->end = pool->next + pool->objectSize * POOL_SLAB_OBJECTS;
+    pool->numSlabs++;
+}
+
+/**
+ * @brief Reserva una estructura de un pool
+ *
+ * @param pool POOL_USERS, POOL_EDGES o POOL_POSTS
+ * @return void* Estructura sin inicializar (como malloc)
+ *
+ * @note Primero reutiliza las estructuras liberadas y luego toma la siguiente del último bloque. En un hilo con caché
+ *       (@see allocator_cache_begin) la toma de los bloques del hilo, sin lock
+ */
+void *pool_alloc(int pool){
+    MemoryPool *memoryPool = &pools[pool];
+    if (threadCache) {
+        PoolCache *cache = &threadCache->pools[pool];
+        if (cache->next == cache->end) {
+            PoolSlab *slab = new_pool_slab(memoryPool->objectSize);
+            slab->next = cache->slabs;
+            cache->slabs = slab;
+            cache->next = (char *)slab + ALIGNED_SIZE(sizeof(PoolSlab));
+            cache->end = cache->next + memoryPool->objectSize * POOL_SLAB_OBJECTS;
+            cache->numSlabs++;
+        }
+        void *object = cache->next;
+        cache->next += memoryPool->objectSize;
+        cache->allocations++;
+        return object;
+    }
+    pthread_mutex_lock(&memoryPool->lock);
+    void *object = memoryPool->freeList;
+    if (object) {
+        memoryPool->freeList = *(void **)object;
+    }
+    else {
+        if (memoryPool->next == memoryPool->end) add_pool_slab(memoryPool);
+        object = memoryPool->next;
+        memoryPool->next += memoryPool->objectSize;
+    }
+    memoryPool->inUse++;
+    memoryPool->allocations++;
+    if (memoryPool->inUse > memoryPool->peakInUse) memoryPool->peakInUse = memoryPool->inUse;
+    pthread_mutex_unlock(&memoryPool->lock);
+    return object;
+}
+
+/**
+ * @brief Devuelve una estructura a su pool para reutilizarla
+ *
+ * @param pool Pool del que se reservó
+ * @param object Estructura (puede ser NULL)
+ */
+void pool_free(int pool, void *object){
+    if (!object) return;
+    MemoryPool *memoryPool = &pools[pool];
+    pthread_mutex_lock(&memoryPool->lock);
+    *(void **)object = memoryPool->freeList;
+    memoryPool->freeList = object;
+    memoryPool->inUse--;
+    pthread_mutex_unlock(&memoryPool->lock);
+}
+
+/**
+ * @brief Busca la posición de un bloque en el arreglo de bloques de la arena
+ *
+ * @param address Dirección del bloque o de un string dentro de él
+ * @return long long Posición del último bloque que empieza antes o en address, -1 si no hay ninguno (con el lock de la arena tomado)
+ */
+static long long find_arena_chunk(const char *address){
+    long long low = 0, high = arena.numChunks;
+    while (low < high) {
+        long long middle = low + (high - low) / 2;
+        if ((const char *)arena.chunks[middle] <= address) low = middle + 1;
+        else high = middle;
+    }
+    return low - 1;
+}
+
+/**
+ * @brief Agrega un puntero a un arreglo de bloques de strings, duplicando su capacidad si está lleno
+ *
+ * @param chunks Arreglo de bloques
+ * @param numChunks Cantidad de bloques
+ * @param chunkCapacity Capacidad del arreglo
+ * @return int 0 si hay espacio para uno más, -1 si no hay memoria
+ */
+static int reserve_chunk_slot(ArenaChunk ***chunks, long long numChunks, long long *chunkCapacity){
+    if (numChunks < *chunkCapacity) return 0;
+    long long capacity = *chunkCapacity ? *chunkCapacity * 2 : ARENA_INITIAL_CHUNK_SLOTS;
+    ArenaChunk **grown = (ArenaChunk **)realloc(*chunks, capacity * sizeof(ArenaChunk *));
+    if (!grown) return -1;
+    *chunks = grown;
+    *chunkCapacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief Reserva con malloc un bloque de strings
+ *
+ * @param size Bytes del bloque
+ * @return ArenaChunk* Bloque vacío
+ */
+static ArenaChunk *new_arena_chunk(size_t size){
+    ArenaChunk *chunk = (ArenaChunk *)malloc(ALIGNED_SIZE(sizeof(ArenaChunk)) + size);
+    if (!chunk) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    chunk->size = size;
+    chunk->used = 0;
+    chunk->live = 0;
+    return chunk;
+}
+
+/**
+ * @brief Agrega un bloque al arreglo de bloques de la arena, manteniéndolo ordenado por dirección
+ *
+ * @param chunk Bloque (con el lock de la arena tomado)
+ */
+static void insert_arena_chunk(ArenaChunk *chunk){
+    if (reserve_chunk_slot(&arena.chunks, arena.numChunks, &arena.chunkCapacity) != 0) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    long long position = find_arena_chunk((const char *)chunk) + 1;
+    memmove(arena.chunks + position + 1, arena.chunks + position, (arena.numChunks - position) * sizeof(ArenaChunk *));
+    arena.chunks[position] = chunk;
+    arena.numChunks++;
+    arena.reservedBytes += chunk->size;
+}
+
+/**
+ * @brief Reserva un bloque nuevo para la arena de strings
+ *
+ * @param minimum Bytes mínimos que debe tener
+ * @return ArenaChunk* Bloque (con el lock de la arena tomado)
+ *
+ * @note Un string que no cabe en un bloque normal recibe un bloque propio y el bloque actual no cambia
+ */
+static ArenaChunk *add_arena_chunk(size_t minimum){
+    ArenaChunk *chunk = new_arena_chunk(minimum > arena.nextChunkSize ? minimum : arena.nextChunkSize);
+    insert_arena_chunk(chunk);
+    return chunk;
+}
+
+/**
+ * @brief Devuelve a malloc un bloque de la arena sin strings en uso
+ *
+ * @param position Posición del bloque en el arreglo de bloques (con el lock de la arena tomado)
+ */
+static void free_arena_chunk(long long position){
+    ArenaChunk *chunk = arena.chunks[position];
+    memmove(arena.chunks + position, arena.chunks + position + 1, (arena.numChunks - position - 1) * sizeof(ArenaChunk *));
+    arena.numChunks--;
+    arena.reservedBytes -= chunk->size;
+    arena.usedBytes -= chunk->used;
+    arena.releasedBytes -= chunk->used;
+    arena.reclaimedBytes += chunk->size;
+    free(chunk);
+}
+
+/**
+ * @brief Copia un string en la arena
+ *
+ * @param string String a copiar
+ * @return char* Copia, que se libera con @see arena_release o junto con toda la arena
+ *
+ * @note En un hilo con caché (@see allocator_cache_begin) se copia en los bloques del hilo, sin lock
+ */
+char *arena_strdup(const char *string){
+    size_t length = strlen(string) + 1;
+    if (threadCache) {
+        AllocatorCache *cache = threadCache;
+        ArenaChunk *chunk = cache->current;
+        if (!chunk || chunk->size - chunk->used < length) {
+            chunk = new_arena_chunk(length > cache->nextChunkSize ? length : cache->nextChunkSize);
+            if (reserve_chunk_slot(&cache->chunks, cache->numChunks, &cache->chunkCapacity) != 0) {
+                printf("ERROR: No hay memoria suficiente\n");
+                exit(EXIT_FAILURE);
+            }
+            cache->chunks[cache->numChunks++] = chunk;
+            if (length <= cache->nextChunkSize) {
+                cache->current = chunk;
+                if (cache->nextChunkSize < ARENA_MAX_CHUNK) cache->nextChunkSize *= 2;
+            }
+        }
+        char *copy = CHUNK_DATA(chunk) + chunk->used;
+        memcpy(copy, string, length);
+        chunk->used += length;
+        chunk->live++;
+        cache->usedBytes += length;
+        cache->strings++;
+        return copy;
+    }
+    pthread_mutex_lock(&arena.lock);
+    ArenaChunk *chunk = arena.current;
+    if (!chunk || chunk->size - chunk->used < length) {
+        chunk = add_arena_chunk(length);
+        if (length <= arena.nextChunkSize) {
+            /* el bloque anterior ya no recibe strings: si no le queda ninguno en uso se devuelve */
+            ArenaChunk *previous = arena.current;
+            arena.current = chunk;
+            if (arena.nextChunkSize < ARENA_MAX_CHUNK) arena.nextChunkSize *= 2;
+            if (previous && previous->live == 0) free_arena_chunk(find_arena_chunk((const char *)previous));
+        }
+    }
+    char *copy = CHUNK_DATA(chunk) + chunk->used;
+    memcpy(copy, string, length);
+    chunk->used += length;
+    chunk->live++;
+    arena.usedBytes += length;
+    arena.strings++;
+    pthread_mutex_unlock(&arena.lock);
+    return copy;
+}
+
+/**
+ * @brief Libera un string de la arena
+ *
+ * @param string String (puede ser NULL)
+ * @return int 1 si el string es de la arena, 0 si no (hay que liberarlo de otra forma)
+ *
+ * @note El bloque del string se busca con búsqueda binaria, O(log bloques). Cuando un bloque que ya no recibe strings queda sin
+ *       strings en uso se devuelve a malloc; si no, su memoria se recupera al liberar toda la arena (@see release_all_memory)
+ */
+int arena_release(const void *string){
+    if (!string) return 0;
+    const char *address = (const char *)string;
+    int found = 0;
+    pthread_mutex_lock(&arena.lock);
+    long long position = find_arena_chunk(address);
+    if (position >= 0) {
+        ArenaChunk *chunk = arena.chunks[position];
+        if (address >= CHUNK_DATA(chunk) && address < CHUNK_DATA(chunk) + chunk->used) {
+            arena.releasedBytes += strlen(address) + 1;
+            chunk->live--;
+            if (chunk->live == 0 && chunk != arena.current) free_arena_chunk(position);
+            found = 1;
+        }
+    }
+    pthread_mutex_unlock(&arena.lock);
+    return found;
+}
+
+/**
+ * @brief Hace que el hilo actual reserve de sus propios bloques hasta @see allocator_cache_end
+ *
+ * @param cache Caché del hilo, que debe seguir existiendo hasta juntarla con @see allocator_cache_merge
+ */
+void allocator_cache_begin(AllocatorCache *cache){
+    memset(cache, 0, sizeof(*cache));
+    cache->nextChunkSize = ARENA_INITIAL_CHUNK;
+    threadCache = cache;
+}
+
+/**
+ * @brief Vuelve a reservar de los pools y la arena globales en el hilo actual
+ */
+void allocator_cache_end(void){
+    threadCache = NULL;
+}
+
+/**
+ * @brief Junta a los pools y la arena los bloques de la caché de un hilo que ya terminó
+ *
+ * @param cache Caché (queda vacía)
+ *
+ * @note Las estructuras sin usar del último bloque de cada pool pasan a la lista de liberadas. Se toma cada lock una vez por
+ *       hilo, en vez de una vez por estructura o string
+ */
+void allocator_cache_merge(AllocatorCache *cache){
+    for (int i = 0; i < NUM_POOLS; i++) {
+        MemoryPool *memoryPool = &pools[i];
+        PoolCache *poolCache = &cache->pools[i];
+        if (!poolCache->slabs) continue;
+        pthread_mutex_lock(&memoryPool->lock);
+        PoolSlab *last = poolCache->slabs;
+        while (last->next) last = last->next;
+        last->next = memoryPool->slabs;
+        memoryPool->slabs = poolCache->slabs;
+        for (char *object = poolCache->next; object < poolCache->end; object += memoryPool->objectSize) {
+            *(void **)object = memoryPool->freeList;
+            memoryPool->freeList = object;
+        }
+        memoryPool->numSlabs += poolCache->numSlabs;
+        memoryPool->inUse += poolCache->allocations;
+        memoryPool->allocations += poolCache->allocations;
+        if (memoryPool->inUse > memoryPool->peakInUse) memoryPool->peakInUse = memoryPool->inUse;
+        pthread_mutex_unlock(&memoryPool->lock);
+    }
+
+    pthread_mutex_lock(&arena.lock);
+    for (long long i = 0; i < cache->numChunks; i++) insert_arena_chunk(cache->chunks[i]);
+    arena.usedBytes += cache->usedBytes;
+    arena.strings += cache->strings;
+    pthread_mutex_unlock(&arena.lock);
+    free(cache->chunks);
+    memset(cache, 0, sizeof(*cache));
+}
+
+/**
+ * @brief Imprime el uso de cada pool y de la arena de strings
+ */
+void print_memory_stats(void){
+    printf("Memoria reservada por DevGraph:\n");
+    for (int i = 0; i < NUM_POOLS; i++) {
+        MemoryPool *memoryPool = &pools[i];
+        pthread_mutex_lock(&memoryPool->lock);
+        long long capacity = memoryPool->numSlabs * POOL_SLAB_OBJECTS;
+        printf("- %s: %lld en uso (máximo %lld) de %lld reservados en %lld bloques, %zu bytes cada uno, %lld reservas en total\n",
+               memoryPool->name, memoryPool->inUse, memoryPool->peakInUse, capacity, memoryPool->numSlabs,
+               memoryPool->objectSize, memoryPool->allocations);
+        pthread_mutex_unlock(&memoryPool->lock);
+    }
+    pthread_mutex_lock(&arena.lock);
+    printf("- strings: %lld copiados, %lld bytes usados de %lld reservados en %lld bloques, %lld bytes ya no se usan, "
+           "%lld bytes devueltos\n", arena.strings, arena.usedBytes, arena.reservedBytes, arena.numChunks, arena.releasedBytes,
+           arena.reclaimedBytes);
+    pthread_mutex_unlock(&arena.lock);
+}
+
+/**
+ * @brief Libera de una vez todos los bloques de los pools y de la arena de strings
+ *
+ * @note Ejecutar al final del programa: todo lo reservado con pool_alloc y arena_strdup deja de ser válido
+ */
+void release_all_memory(void){
+    for (int i = 0; i < NUM_POOLS; i++) {
+        MemoryPool *memoryPool = &pools[i];
+        pthread_mutex_lock(&memoryPool->lock);
+        while (memoryPool->slabs) {
+            PoolSlab *next = memoryPool->slabs->next;
+            free(memoryPool->slabs);
+            memoryPool->slabs = next;
+        }
+        memoryPool->freeList = NULL;
+        memoryPool->next = memoryPool->end = NULL;
+        memoryPool->numSlabs = 0;
+        memoryPool->inUse = 0;
+        pthread_mutex_unlock(&memoryPool->lock);
+    }
+    pthread_mutex_lock(&arena.lock);
+    for (long long i = 0; i < arena.numChunks; i++) free(arena.chunks[i]);
+    free(arena.chunks);
+    arena.chunks = NULL;
+    arena.numChunks = 0;
+    arena.chunkCapacity = 0;
+    arena.current = NULL;
+    arena.nextChunkSize = ARENA_INITIAL_CHUNK;
+    arena.reservedBytes = 0;
+    arena.usedBytes = 0;
+    arena.releasedBytes = 0;
+    arena.reclaimedBytes = 0;
+    pthread_mutex_unlock(&arena.lock);
+}
@@ -0,0 +1,207 @@
+/**
+ * @file batch.c
+ * @brief Ejecución por lotes: varios comandos, de distintos usuarios, sobre una sola carga de la base de datos
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#include "batch.h"
+
+static Graph batchGraph = NULL; /* grafo del lote en ejecución, @see save_batch_at_exit */
+static GlobalInterests batchGlobalInterests; /* intereses globales del lote en ejecución */
+
+/**
+ * @brief Guarda los cambios del lote si un comando termina el programa (por ejemplo con exit ante una entrada inválida)
+ */
+static void save_batch_at_exit(void){
+    if (!batchGraph) return;
+    defer_user_saves(0);
+    flush_database(batchGraph, batchGlobalInterests);
+}
+
+/**
+ * @brief Segundos de un reloj monótono
+ *
+ * @return double Segundos
+ */
+static double monotonic_seconds(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Nombre del resultado de un comando en la salida del lote
+ *
+ * @param status COMMAND_OK, COMMAND_ERROR o COMMAND_NO_SESSION
+ * @return const char* "OK", "ERROR" o "SIN_SESION"
+ */
+static const char *status_name(int status){
+    if (status == COMMAND_OK) return "OK";
+    if (status == COMMAND_NO_SESSION) return "SIN_SESION";
+    return "ERROR";
+}
+
+/**
+ * @brief Convierte la entrada de una línea del lote en la entrada del comando
+ *
+ * @param text Texto después de BATCH_INPUT_SEPARATOR y su espacio (se modifica)
+ * @return size_t Bytes de entrada
+ *
+ * @note '\\n' se convierte en un salto de línea y '\\\\' en una barra; al final se agrega un salto de línea
+ */
+static size_t decode_input(char *text){
+    char *source = text, *destination = text;
+    while (*source) {
+        if (source[0] == '\\' && source[1] == 'n') {
+            *destination++ = '\n';
+            source += 2;
+        }
+        else if (source[0] == '\\' && source[1] == '\\') {
+            *destination++ = '\\';
+            source += 2;
+        }
+        else {
+            *destination++ = *source++;
+        }
+    }
+    *destination++ = '\n';
+    return destination - text;
+}
+
+/**
+ * @brief Ejecuta una línea del lote
+ *
+ * @param line Línea sin el salto de línea final (se modifica)
+ * @param program Nombre del programa, para argv[0]
+ * @param output Salida del comando (se reserva, liberar con free)
+ * @param outputLength Bytes de salida
+ * @param table Tabla hash de usuarios
+ * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ * @return int COMMAND_OK, COMMAND_ERROR o COMMAND_NO_SESSION
+ */
+static int run_batch_line(char *line, char *program, char **output, size_t *outputLength,
+                          PtrToHashTable table, Graph graph, GlobalInterests globalInterests){
+    char *input = strchr(line, BATCH_INPUT_SEPARATOR);
+    size_t inputLength = 0;
+    if (input) {
+        *input++ = '\0';
+        if (*input == ' ') input++;
+        inputLength = decode_input(input);
+    }
+
+    char *argv[BATCH_MAX_ARGS + 2];
+    int argc = 0;
+    char *savePointer = NULL;
+    char *username = strtok_r(line, " \t", &savePointer);
+    argv[argc++] = program;
+    for (char *token = strtok_r(NULL, " \t", &savePointer); token; token = strtok_r(NULL, " \t", &savePointer)) {
+        if (argc == BATCH_MAX_ARGS + 1) {
+            *output = strdup("ERROR: Demasiados argumentos\n");
+            *outputLength = strlen(*output);
+            return COMMAND_ERROR;
+        }
+        argv[argc++] = token;
+    }
+    argv[argc] = NULL;
+
+    if (!username || argc < 2) {
+        *output = strdup("ERROR: Falta el comando\n");
+        *outputLength = strlen(*output);
+        return COMMAND_ERROR;
+    }
+
+    User user = NULL;
+    if (strcmp(username, BATCH_SESSION_USER) != 0) {
+        user = search_user(username, table);
+        if (!user) {
+            *outputLength = 0;
+            FILE *message = open_memstream(output, outputLength);
+            if (!message) {
+                printf("ERROR: No hay memoria suficiente\n");
+                exit(EXIT_FAILURE);
+            }
+            fprintf(message, "ERROR: Usuario '%s' no encontrado\n", username);
+            fclose(message);
+            return COMMAND_ERROR;
+        }
+    }
+    return run_command_captured(argc, argv, user, input, inputLength, output, outputLength, table, graph, globalInterests);
+}
+
+/**
+ * @brief Ejecuta los comandos de un archivo, uno por línea, y guarda los cambios una sola vez al final
+ *
+ * @param path Archivo con los comandos, o "-" para leerlos de la entrada estándar
+ * @param table Tabla hash de usuarios
+ * @param graph Grafo de usuarios (ya cargado)
+ * @param globalInterests Tabla de intereses globales
+ * @return int COMMAND_OK, o COMMAND_ERROR si no se pudo abrir el archivo o algún comando falló
+ *
+ * @note Cada línea es '<usuario> <comando> [argumentos] [| entrada]', donde el usuario es BATCH_SESSION_USER para usar la sesión
+ *       iniciada en la terminal y la entrada es lo que el comando leería de la terminal ('\\n' separa líneas). Las líneas vacías o que empiezan
+ *       con '#' se ignoran. Por ejemplo:
+ *       ana -f pedro
+ *       ana -p | Hola a todos
+ *       pedro -q | 2
+ *       - -r | juan\\nclave\\nJuan Pérez\\n3\\n0
+ * @note Por cada comando se imprime la línea '<número de línea> <OK|ERROR|SIN_SESION> <microsegundos> <bytes>' seguida de los
+ *       bytes de salida del comando, y al final una línea 'RESUMEN' con el total de comandos y su rendimiento
+ * @note Si un comando termina el programa, los cambios de los comandos anteriores igual se guardan (@see save_batch_at_exit)
+ */
+int run_batch(const char *path, PtrToHashTable table, Graph graph, GlobalInterests globalInterests){
+    FILE *file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!file) {
+        printf("ERROR: No se pudo abrir el archivo '%s'\n", path);
+        return COMMAND_ERROR;
+    }
+
+    char program[] = "devgraph";
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    ssize_t lineLength;
+    int lineNumber = 0, commands = 0, failed = 0;
+
+    batchGraph = graph;
+    batchGlobalInterests = globalInterests;
+    atexit(save_batch_at_exit);
+    defer_user_saves(1);
+    double start = monotonic_seconds();
+    while ((lineLength = getline(&line, &lineCapacity, file)) != -1) {
+        lineNumber++;
+        while (lineLength > 0 && (line[lineLength - 1] == '\n' || line[lineLength - 1] == '\r')) line[--lineLength] = '\0';
+        size_t skip = strspn(line, " \t");
+        if (line[skip] == '\0' || line[skip] == '#') continue;
+
+        char *output = NULL;
+        size_t outputLength = 0;
+        double commandStart = monotonic_seconds();
+        int status = run_batch_line(line + skip, program, &output, &outputLength, table, graph, globalInterests);
+        long long microseconds = (long long)((monotonic_seconds() - commandStart) * 1e6);
+
+        printf("%d %s %lld %zu\n", lineNumber, status_name(status), microseconds, outputLength);
+        fwrite(output, 1, outputLength, stdout);
+        free(output);
+        commands++;
+        if (status != COMMAND_OK) failed++;
+    }
+    double elapsed = monotonic_seconds() - start;
+    free(line);
+    if (file != stdin) fclose(file);
+
+    double saveStart = monotonic_seconds();
+    batchGraph = NULL;
+    defer_user_saves(0);
+    flush_database(graph, globalInterests);
+    double saveElapsed = monotonic_seconds() - saveStart;
+
+    printf("RESUMEN comandos=%d ok=%d errores=%d segundos=%.3f comandos_por_segundo=%.1f guardado_segundos=%.3f\n",
+           commands, commands - failed, failed, elapsed, elapsed > 0 ? commands / elapsed : 0.0, saveElapsed);
+    return failed ? COMMAND_ERROR : COMMAND_OK;
+}
@@ -0,0 +1,277 @@
+/**
+ * @file commands.c
+ * @brief Ejecución de los comandos del programa sobre la base de datos ya cargada
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#include "commands.h"
+
+/**
+ * @brief Indica si un comando requiere una sesión iniciada
+ *
+ * @param option Opción obtenida con get_option
+ * @return int 1 si la requiere
+ */
+int command_requires_session(int option){
+    return option==5||option==6||option==9||option==10||option==11||option==13||option==14||option==15||option==17||option==18||option==19;
+}
+
+/**
+ * @brief Indica si un comando lee datos de la entrada estándar
+ *
+ * @param option Opción obtenida con get_option
+ * @return int 1 si la lee
+ */
+int command_reads_input(int option){
+    return option==1||option==4||option==5||option==13||option==14;
+}
+
+/**
+ * @brief Ejecuta un comando sobre la base de datos cargada
+ *
+ * @param option Opción obtenida con get_option
+ * @param argc Número de argumentos
+ * @param argv Argumentos (el argumento del comando está en argv[2]; en el feed y las sugerencias es opcional y es la cantidad de resultados)
+ * @param table Tabla hash de usuarios
+ * @param graph Grafo de usuarios
+ * @param globalInterestsTable Tabla de intereses globales
+ * @param sessionUser Usuario que ejecuta el comando, o NULL para usar la sesión iniciada (@see current_session)
+ * @return int COMMAND_OK, COMMAND_ERROR o COMMAND_NO_SESSION
+ *
+ * @note Lee de stdin y escribe en stdout, así el servidor puede ejecutar comandos con la entrada y salida de cada cliente
+ */
+int run_command(int option, int argc, char *argv[], PtrToHashTable table, Graph graph, GlobalInterests globalInterestsTable, User sessionUser){
+    User currentUser = NULL;
+    heap feed;
+    init_heap(&feed, 0);
+    TopK best;
+    int resultLimit = 0;
+    int status = COMMAND_OK;
+
+    // los comandos con argumento lo leen de argv[2]
+    if((option==7||option==9||option==10) && argc < 3){
+        printf("ERROR: Falta el nombre de usuario\n");
+        return COMMAND_ERROR;
+    }
+    // el feed y las sugerencias aceptan en argv[2] la cantidad de resultados que se guardan
+    if((option==14||option==15||option==19) && argc >= 3){
+        if(sscanf(argv[2], "%d", &resultLimit)!=1 || resultLimit<1){
+            printf("ERROR: La cantidad de resultados debe ser un número mayor a 0\n");
+            return COMMAND_ERROR;
+        }
+    }
+
+    // verificación para comandos que requieren una sesión iniciada
+    if(command_requires_session(option)){
+        currentUser = sessionUser ? sessionUser : current_session(table);
+        if(!currentUser){
+            printf("ERROR: No se ha iniciado sesión. Ejecute './devgraph -l' para iniciar sesión.\n");
+            return COMMAND_NO_SESSION;
+        }
+    }
+
+    /* COMANDOS DEL PROGRAMA */
+    switch (option){
+
+    case 1: /* INICIO DE SESIÓN */
+        if (login(table) != 0) status = COMMAND_ERROR;
+        break;
+
+    case 2: /* CIERRA SESIÓN */
+        logout();
+        break;
+    
+    case 4: /* REGISTRAR USUARIO */
+        if (register_user(table, graph, globalInterestsTable) != 0) status = COMMAND_ERROR;
+        break;
+
+    case 5: /* PUBLICAR PUBLICACIÓN */
+        if (write_post(currentUser, globalInterestsTable) != 0) status = COMMAND_ERROR;
+        break;
+
+    case 6: /* VER PERFIL DEL USUARIO */
+        print_user(currentUser, globalInterestsTable);
+        break;
+
+    case 7: {/* VER USUARIO */
+        User user = search_user(argv[2], table);
+        if(!user){
+            printf("ERROR: Usuario no encontrado\n");
+            return COMMAND_ERROR;
+        }
+        print_logo();
+        print_user(user, globalInterestsTable);
+        break;
+    }
+    case 8: /* VER TODOS LOS USUARIOS */
+        print_logo();
+        print_all_users(graph);
+        break;
+    
+    case 9: /* SEGUIR A UN USUARIO */
+        if (follow(currentUser, argv[2], globalInterestsTable, table) != 0) status = COMMAND_ERROR;
+        break;
+    
+    case 10: /* DEJAR DE SEGUIR A UN USUARIO */
+        if (unfollow(currentUser, argv[2], globalInterestsTable, table) != 0) status = COMMAND_ERROR;
+        break;
+    
+    case 11: /* BORRAR CUENTA */
+        delete_account(currentUser, table, graph);
+        break;
+
+    case 12: /* BORRAR BASE DE DATOS */
+        printf("Preparando, por favor espere...\n");
+        remove("current.dat");
+        remove(SIMILARITY_FILE);
+        clear_database();
+        break;
+    
+    case 13: /* EDITAR INFORMACIÓN DEL USUARIO */
+        print_logo();
+        if (edit_account(currentUser, globalInterestsTable, table) != 0) status = COMMAND_ERROR;
+        break;
+    
+    case 14: { /* MOSTRAR POSTS */
+        FeedCandidates candidates;
+        init_top_k(&best, resultLimit ? resultLimit : FEED_TOP_K, 0);
+        init_feed_candidates(&candidates, &best, load_feed_weights(FEED_WEIGHTS_FILE));
+        search_posts_in_my_follows(&candidates, currentUser);
+        search_posts_by_interests(&candidates, graph, globalInterestsTable, currentUser);
+        flush_feed_candidates(&candidates);
+        free_feed_candidates(&candidates);
+        top_k_to_heap(&best, &feed);
+        free_top_k(&best);
+        watch_posts(&feed);
+        free_heap(&feed);
+        break;
+    }
+    
+    case 15: { /* MOSTRAR USUARIOS RECOMENDADOS*/
+        print_logo();
+        dijkstra_bounded(&feed, get_csr_graph(graph), graph, currentUser, resultLimit ? resultLimit : SUGGESTIONS_MAX_RESULTS, SUGGESTIONS_MAX_HOPS, SUGGESTIONS_MAX_DISTANCE);
+        watch_suggestions_friends_of_friends(&feed);
+        init_top_k(&best, resultLimit ? resultLimit : SUGGESTIONS_TOP_K, 1);
+        if (!search_precomputed_possible_friends(&best, graph, globalInterestsTable, currentUser)) {
+            search_new_possible_friends(&best, graph, NULL, globalInterestsTable, currentUser);
+        }
+        top_k_to_heap(&best, &feed);
+        free_top_k(&best);
+        watch_suggestions_by_interests(&feed, currentUser, globalInterestsTable);
+        free_heap(&feed);
+        break;
+    }
+    
+    case 16: /* MOSTRAR TEMAS */
+        printf("Tópicos de DevGraph:\n");
+        print_global_interests(globalInterestsTable);
+        break;
+    
+    case 17: /* MOSTRAR SEGUIDORES DEL USUARIO */
+        print_followers(currentUser);
+        break;
+    
+    case 18: /* MOSTRAR SEGUIDOS DEL USUARIO */
+        print_following(currentUser);
+        break;
+
+    case 19: { /* MOSTRAR USUARIOS SIMILARES (APROXIMADO) */
+        print_logo();
+        LshIndex lsh = cached_lsh_index(graph, globalInterestsTable);
+        init_top_k(&best, resultLimit ? resultLimit : SUGGESTIONS_TOP_K, 1);
+        search_new_possible_friends(&best, graph, lsh, globalInterestsTable, currentUser);
+        top_k_to_heap(&best, &feed);
+        free_top_k(&best);
+        watch_suggestions_by_interests(&feed, currentUser, globalInterestsTable);
+        free_heap(&feed);
+        break;
+    }
+
+    case 20: /* MEDIR RECALL DE LSH */
+        measure_lsh_recall(graph, globalInterestsTable);
+        break;
+
+    case 21: /* PRECALCULAR USUARIOS SIMILARES */
+        compute_similarity_join(graph, globalInterestsTable, SIMILARITY_FILE);
+        break;
+
+    case 22: /* MIGRAR BASE DE DATOS AL SNAPSHOT */
+        migrate_database(graph, globalInterestsTable);
+        break;
+
+    case 23: /* INCORPORAR EL WAL AL SNAPSHOT */
+        compact_database(graph, globalInterestsTable);
+        break;
+
+    case 27: /* MOSTRAR MEMORIA USADA */
+        printf("Usuarios cargados: %d\n", graph->usersNumber);
+        print_memory_stats();
+        break;
+
+    default:
+        break;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Ejecuta un comando con una entrada dada y guarda lo que imprime
+ *
+ * @param argc Cantidad de argumentos
+ * @param argv Argumentos, como los del programa
+ * @param sessionUser Usuario que ejecuta el comando, o NULL para usar la sesión iniciada
+ * @param input Entrada del comando
+ * @param inputLength Bytes de entrada
+ * @param output Salida del comando (se reserva, liberar con free)
+ * @param outputLength Bytes de salida
+ * @param table Tabla hash de usuarios
+ * @param graph Grafo de usuarios
+ * @param globalInterestsTable Tabla de intereses globales
+ * @return int COMMAND_OK, COMMAND_ERROR o COMMAND_NO_SESSION
+ *
+ * @note stdin y stdout se reemplazan mientras corre el comando, así los comandos no cambian. Se rechazan los comandos que no
+ *       tienen sentido con la base de datos ya cargada (generar, borrar la base de datos, servidor, cliente y lote) y, si se
+ *       indica sessionUser, los que cambian la sesión de la terminal (iniciar y cerrar sesión, borrar y editar la cuenta)
+ */
+int run_command_captured(int argc, char *argv[], User sessionUser, char *input, size_t inputLength, char **output, size_t *outputLength,
+                         PtrToHashTable table, Graph graph, GlobalInterests globalInterestsTable){
+    FILE *commandInput = inputLength > 0 ? fmemopen(input, inputLength, "r") : fopen("/dev/null", "r");
+    FILE *commandOutput = open_memstream(output, outputLength);
+    if (!commandInput || !commandOutput) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    FILE *savedInput = stdin, *savedOutput = stdout;
+    fflush(stdout);
+    stdin = commandInput;
+    stdout = commandOutput;
+
+    optind = 0; /* get_option usa getopt, que guarda su posición entre llamadas */
+    int option = get_option(argc, argv);
+    int status = COMMAND_OK;
+    if (option == 3 || option == 12 || option == OPTION_SERVE || option == OPTION_CLIENT || option == OPTION_BATCH ||
+        (sessionUser && (option == 1 || option == 2 || option == 11 || option == 13))) {
+        printf("ERROR: Este comando no está disponible en este modo.\n");
+        status = COMMAND_ERROR;
+    }
+    else if (option < 0) {
+        status = COMMAND_ERROR;
+    }
+    else if (option > 0) {
+        status = run_command(option, argc, argv, table, graph, globalInterestsTable, sessionUser);
+    }
+
+    fflush(stdout);
+    stdin = savedInput;
+    stdout = savedOutput;
+    fclose(commandInput);
+    fclose(commandOutput);
+    return status;
+}
@@ -14,6 +14,16 @@
 
 #include "database.h"
 
+static int snapshotMode = 0; /* 1 si la base de datos cargada está en DATABASE_SNAPSHOT_FILE */
+static int walGeneration = 0; /* generación del WAL incorporada en el snapshot cargado */
+static char *walBuffer = NULL; /* registros del WAL que aún no se escriben (group commit) */
+static size_t walBufferSize = 0; /* bytes usados de walBuffer */
+static size_t walBufferCapacity = 0; /* bytes reservados de walBuffer */
+static char *snapshotMapping = NULL; /* snapshot mapeado en memoria, @see load_snapshot */
+static size_t snapshotMappingSize = 0; /* tamaño del snapshot mapeado */
+static struct _lazyDatabase *lazyDatabase = NULL; /* carga parcial del snapshot, NULL si la base de datos se cargó completa */
+static int deferredSaves = 0; /* 1 si save_user_data deja los cambios para flush_database, @see defer_user_saves */
+
 /**
  * @brief Crea el directorio 'database' si no existe.
  * 
@@ -29,8 +39,34 @@ void create_database_dir(void){
 }
 
 /**
- * @brief Guarda toda la información de un usuario en la base de datos
+ * @brief Toma el flock de DATABASE_LOCK_FILE hasta que termina el programa
+ *
+ * @param exclusive 1 para el servidor, que no comparte la base de datos; 0 para los comandos directos, que pueden correr a la vez
+ * @return int 0 si se tomó el lock, -1 si otro proceso lo tiene (o no se pudo abrir el archivo)
+ *
+ * @note Sin el lock un comando directo escribiría el snapshot o el WAL mientras el servidor tiene en memoria una versión
+ *       anterior del grafo, y uno de los dos perdería los cambios del otro
+ */
+int lock_database(int exclusive){
+    create_database_dir();
+    int fd = open(DATABASE_LOCK_FILE, O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if (fd == -1) return -1;
+    int result;
+    do {
+        result = flock(fd, (exclusive ? LOCK_EX : LOCK_SH) | LOCK_NB);
+    } while (result == -1 && errno == EINTR);
+    if (result == -1) {
+        close(fd);
+        return -1;
+    }
+    return 0; /* el descriptor queda abierto: el lock se libera al terminar el proceso */
+}
+
+/**
+ * @brief Guarda la información con cambios de un usuario en la base de datos
  * @note Se guardan los en la carpeta "database/{username}_data". Su info como usuario está en "database/{username}_data/data.dat", sus seguidores en "database/{username}_data/following.dat" y sus seguidores en "database/{username}_data/followers.dat". Sus publicaciones estarán en "database/{username}_data/posts", cada post siendo un archivo teniendo de nombre la fecha en formato "AAAA-MM-DD HH:MM:SS".
+ * @note Solo se reescriben los archivos marcados en user->dirty y solo se agregan los posts que aún no están guardados (@see USER_DIRTY_PROFILE).
+ *       Si la carpeta del usuario no existe se guarda todo.
  *
  * @param user Usuario a guardar
  * @param globalInterests Tabla de intereses globales
@@ -38,10 +74,11 @@ void create_database_dir(void){
 void save_user_data(User user, GlobalInterests globalInterests){
     
     if (!user) return;
+    if (snapshotMode) return; /* los cambios van al WAL, @see append_wal_record */
+    if (deferredSaves) return; /* el usuario queda marcado y se guarda en flush_database */
     char filename[512];
     struct stat st = {0};
     FILE *fp;
-    Edge e;
     /* crear directorio del usuario si no existe */
     snprintf(filename, sizeof(filename), "database/%s_data", user->username);
     if (stat(filename, &st) == -1) {
@@ -49,54 +86,58 @@ void save_user_data(User user, GlobalInterests globalInterests){
             printf("ERROR: No se pudo crear el directorio '%s'\n", filename);
             exit(EXIT_FAILURE);
         }
+        user->dirty = USER_DIRTY_ALL;
+        user->savedPosts = 0;
     }
     /* guardar datos */
-    snprintf(filename, sizeof(filename), "database/%s_data/data.dat", user->username);
-    fp = fopen(filename, "w");
-    if(!fp){
-        printf("ERROR: No se pudo guardar el archivo '%s'\n", filename);
-        return;
-    }
-    fprintf(fp, "%d\n", user->id);
-    fprintf(fp, "%s\n", user->username);
-    fprintf(fp, "%s\n", user->password);
-    fprintf(fp, "%s\n", user->name);
-    fprintf(fp, "%d\n", user->popularity);
-    // Amigabilidad y categoría
-    float f = calculate_friendliness(user);
-    const char *cat = classify_friendliness(f);
-    fprintf(fp, "%.2f\n", f); /*friendliness*/
-    fprintf(fp, "%s\n", cat); /*category*/
-    for (int i = 0; i < globalInterests.numInterests; i++) {
-        fprintf(fp, "%d\n", user->interests[i].value); /*interests*/
+    if (user->dirty & USER_DIRTY_PROFILE) {
+        snprintf(filename, sizeof(filename), "database/%s_data/data.dat", user->username);
+        fp = fopen(filename, "w");
+        if(!fp){
+            printf("ERROR: No se pudo guardar el archivo '%s'\n", filename);
+            return;
+        }
+        fprintf(fp, "%d\n", user->id);
+        fprintf(fp, "%s\n", user->username);
+        fprintf(fp, "%s\n", user->password);
+        fprintf(fp, "%s\n", user->name);
+        fprintf(fp, "%d\n", user->popularity);
+        // Amigabilidad y categoría
+        float f = calculate_friendliness(user);
+        const char *cat = classify_friendliness(f);
+        fprintf(fp, "%.2f\n", f); /*friendliness*/
+        fprintf(fp, "%s\n", cat); /*category*/
+        for (int i = 0; i < globalInterests.numInterests; i++) {
+            fprintf(fp, "%d\n", has_interest(user->interests, i)); /*interests*/
+        }
+        fclose(fp);
     }
-    fclose(fp);
 
     /* seguidos */
-    snprintf(filename, sizeof(filename), "database/%s_data/following.dat", user->username);
-    fp = fopen(filename, "w");
-    if(!fp){
-        return;
-    }
-    e = user->following->next;
-    while (e) {
-        fprintf(fp, "  %s\n", e->dest->username);
-        e = e->next;
+    if (user->dirty & USER_DIRTY_FOLLOWING) {
+        snprintf(filename, sizeof(filename), "database/%s_data/following.dat", user->username);
+        fp = fopen(filename, "w");
+        if(!fp){
+            return;
+        }
+        for (int i = 0; i < user->following->size; i++) {
+            fprintf(fp, "  %s\n", user->following->edges[i].dest->username);
+        }
+        fclose(fp);
     }
-    fclose(fp);
 
     /* seguidores */
-    snprintf(filename, sizeof(filename), "database/%s_data/followers.dat", user->username);
-    fp = fopen(filename, "w");
-    if(!fp){
-        return;
-    }
-    e = user->followers->next;
-    while (e) {
-        fprintf(fp, "  %s\n", e->dest->username);
-        e = e->next;
+    if (user->dirty & USER_DIRTY_FOLLOWERS) {
+        snprintf(filename, sizeof(filename), "database/%s_data/followers.dat", user->username);
+        fp = fopen(filename, "w");
+        if(!fp){
+            return;
+        }
+        for (int i = 0; i < user->followers->size; i++) {
+            fprintf(fp, "  %s\n", user->followers->edges[i].dest->username);
+        }
+        fclose(fp);
     }
-    fclose(fp);
 
     /* posts */
 
@@ -107,10 +148,11 @@ void save_user_data(User user, GlobalInterests globalInterests){
             exit(EXIT_FAILURE);
         }
     }
-    delete_all_in_directory(filename); /* borrar archivos dentro para evitar problemas de colisiones */
 
+    /* los posts nuevos se insertan al inicio de la lista, así que solo se recorren los que faltan por guardar */
+    int newPosts = user->posts->id - user->savedPosts;
     PtrToPostNode postAux = user->posts->next;
-    while (postAux) {
+    while (postAux && newPosts > 0) {
         char buffer[128];
         strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &postAux->date);
         snprintf(filename, sizeof(filename), "database/%s_data/posts/%s.dat", user->username, buffer);
@@ -126,39 +168,154 @@ void save_user_data(User user, GlobalInterests globalInterests){
             fprintf(fp, "%s\n", postAux->post); // contenido
         }
         postAux = postAux->next;
+        newPosts--;
         fclose(fp);
         
     }
 
+    user->dirty = 0;
+    user->savedPosts = user->posts->id;
 }
 
 /**
- * @brief Guarda todos los usuarios cargados en el programa en la base de datos.
- * 
+ * @brief Indica si un usuario tiene cambios que aún no están guardados
+ *
+ * @param user Usuario
+ * @return int 1 si tiene cambios sin guardar
+ */
+static int user_has_changes(User user) {
+    return user->dirty != 0 || user->posts->id != user->savedPosts;
+}
+
+/**
+ * @brief Guarda en la base de datos solo los usuarios con cambios sin guardar
+ *
  * @param graph Grafo de usuarios
  * @param globalInterests Tabla de intereses globales
  */
-void save_all_users(Graph graph, GlobalInterests globalInterests) {
-    create_database_dir();
+void save_dirty_users(Graph graph, GlobalInterests globalInterests) {
+    int deferred = deferredSaves;
+    deferredSaves = 0;
     PtrToUser currentUser = graph->graphUsersList->next;
     while (currentUser) {
-        save_user_data(currentUser, globalInterests);
+        if (user_has_changes(currentUser)) save_user_data(currentUser, globalInterests);
         currentUser = currentUser->next;
     }
+    deferredSaves = deferred;
+}
 
+/**
+ * @brief Activa o desactiva el guardado diferido de usuarios
+ *
+ * @param defer 1 para que save_user_data solo deje marcados los usuarios y se guarden todos juntos en flush_database,
+ *              0 para volver a guardar cada usuario al momento
+ *
+ * @note Con el snapshot no cambia nada, los registros del WAL ya se escriben juntos en flush_database
+ */
+void defer_user_saves(int defer) {
+    deferredSaves = defer;
 }
 
 /**
- * @brief Elimina la base de datos en su totalidad.
+ * @brief Guarda todos los usuarios cargados en el programa en la base de datos.
  * 
  * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ *
+ * @note Solo se escriben los usuarios con cambios, @see save_dirty_users
+ */
+void save_all_users(Graph graph, GlobalInterests globalInterests) {
+    create_database_dir();
+    if (snapshotMode) {
+        fold_wal_into_snapshot(graph, globalInterests);
+        return;
+    }
+    save_dirty_users(graph, globalInterests);
+}
+
+/**
+ * @brief Guarda el siguiente id libre del grafo en DATABASE_NEXT_ID_FILE
+ *
+ * @param graph Grafo de usuarios
+ */
+static void save_next_id(Graph graph) {
+    FILE *fp = fopen(DATABASE_NEXT_ID_FILE, "w");
+    if (!fp) {
+        printf("ERROR: No se pudo guardar el archivo '%s'\n", DATABASE_NEXT_ID_FILE);
+        return;
+    }
+    fprintf(fp, "%d\n", graph->nextId);
+    fclose(fp);
+}
+
+/**
+ * @brief Reserva los ids entregados antes de cerrar la base de datos, según DATABASE_NEXT_ID_FILE
+ *
+ * @param graph Grafo de usuarios
+ */
+static void load_next_id(Graph graph) {
+    FILE *fp = fopen(DATABASE_NEXT_ID_FILE, "r");
+    if (!fp) return;
+    int nextId;
+    if (fscanf(fp, "%d", &nextId) == 1 && nextId > 0) reserve_graph_ids(graph, nextId);
+    fclose(fp);
+}
+
+/**
+ * @brief Borra la carpeta "database/{username}_data" de un usuario con todo su contenido
+ *
+ * @param username Nombre de usuario
+ */
+static void remove_user_directory(const char *username) {
+    char path[512];
+    snprintf(path, sizeof(path), "database/%s_data/data.dat", username);
+    remove(path);
+    snprintf(path, sizeof(path), "database/%s_data/following.dat", username);
+    remove(path);
+    snprintf(path, sizeof(path), "database/%s_data/followers.dat", username);
+    remove(path);
+    snprintf(path, sizeof(path), "database/%s_data/posts", username);
+    delete_all_in_directory(path);
+    rmdir(path);
+    snprintf(path, sizeof(path), "database/%s_data", username);
+    rmdir(path);
+}
+
+/**
+ * @brief Indica si una entrada de la carpeta 'database' es la carpeta de un usuario ("{username}_data")
+ *
+ * @param name Nombre de la entrada
+ * @return int 1 si es carpeta de usuario
+ */
+static int is_user_directory(const char *name) {
+    size_t length = strlen(name);
+    return length > 5 && strcmp(name + length - 5, "_data") == 0;
+}
+
+/**
+ * @brief Elimina la base de datos en su totalidad.
+ *
+ * @note No necesita cargar los usuarios: borra el snapshot, el WAL y las carpetas de usuario recorriendo 'database' una vez
  */
-void clear_database(Graph graph) {
-    GraphList aux = graph->graphUsersList->next;
-    while (aux) {
-        delete_account(aux);
-        aux = aux->next;
+void clear_database(void) {
+    int removed = 0;
+    DIR *dir = opendir("database");
+    if (dir) {
+        const struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (!is_user_directory(entry->d_name)) continue;
+            char username[256];
+            snprintf(username, sizeof(username), "%.*s", (int)(strlen(entry->d_name) - strlen("_data")), entry->d_name);
+            remove_user_directory(username);
+            removed++;
+        }
+        closedir(dir);
     }
+    remove(DATABASE_SNAPSHOT_FILE);
+    remove(WAL_FILE);
+    remove(DATABASE_NEXT_ID_FILE);
+    walBufferSize = 0;
+    if (removed > 0) printf("Se borraron las carpetas de %d cuentas.\n", removed);
     printf("Se han eliminado todos los datos de la base de datos.\n");
 }
 
@@ -173,7 +330,8 @@ int database_exists_and_not_empty(void) {
     const struct dirent *entry;
     int has_files = 0;
     while ((entry = readdir(dir)) != NULL) {
-        if (strcmp(entry->d_name,".")!=0 && strcmp(entry->d_name,"..")!=0) {
+        if (strcmp(entry->d_name,".")!=0 && strcmp(entry->d_name,"..")!=0 &&
+            strcmp(entry->d_name, DATABASE_LOCK_FILE + strlen("database/"))!=0) {
             has_files = 1;
             break;
         }
@@ -183,63 +341,99 @@ int database_exists_and_not_empty(void) {
 }
 
 /**
- * @brief Carga un usuario desde un archivo
- * 
- * @param filename Nombre del archivo
- * @param table Tabla hash de usuarios
- * @param graph Grafo de usuarios
+ * @struct _loadedUser
+ * @brief Usuario leído desde su carpeta por un hilo del cargador, antes de agregarlo a la tabla hash y al grafo
+ */
+struct _loadedUser{
+    char *directory; /*!< Carpeta del usuario ("database/{username}_data") */
+    int loaded; /*!< 1 si se pudo leer */
+    int id; /*!< Id guardado */
+    char *username; /*!< Nombre de usuario */
+    char *password; /*!< Contraseña */
+    char *name; /*!< Nombre */
+    char *category; /*!< Categoría de amigabilidad */
+    int popularity; /*!< Popularidad */
+    float friendliness; /*!< Amigabilidad */
+    InterestTable interests; /*!< Intereses */
+    UserPosts posts; /*!< Publicaciones */
+    char **following; /*!< Nombres de usuario de following.dat */
+    int numFollowing; /*!< Cantidad de nombres en following */
+    User user; /*!< Usuario creado al juntar los resultados */
+    User *followingUsers; /*!< Usuarios seguidos, NULL si no existen */
+    double *weights; /*!< Peso de cada conexión */
+};
+
+/**
+ * @struct _loadJob
+ * @brief Datos compartidos por los hilos del cargador
+ */
+struct _loadJob{
+    struct _loadedUser *users; /*!< Un elemento por carpeta de usuario */
+    int numUsers; /*!< Cantidad de carpetas */
+    int nextUser; /*!< Siguiente carpeta sin tomar (se incrementa de forma atómica) */
+    AllocatorCache caches[DATABASE_LOAD_MAX_THREADS]; /*!< Bloques de cada hilo que lee carpetas, @see load_users_worker */
+    int numCaches; /*!< Cachés tomadas por los hilos (se incrementa de forma atómica) */
+    PtrToHashTable table; /*!< Tabla hash de usuarios (solo lectura mientras corren los hilos) */
+    GlobalInterests globalInterests; /*!< Tabla de intereses globales */
+};
+
+/**
+ * @brief Lee la carpeta de un usuario sin tocar la tabla hash ni el grafo
+ *
+ * @param loaded Usuario a llenar, con directory ya asignado
  * @param globalInterests Tabla de intereses globales
- * @return User Usuario cargado
+ * @return int 1 si se pudo leer, 0 si falta data.dat o la carpeta de posts
  */
-User load_user_from_file(const char *filename, PtrToHashTable table, Graph graph, GlobalInterests globalInterests) {
-    char buffer[128];
-    sprintf(buffer, "%s/data.dat", filename);
+static int read_user_directory(struct _loadedUser *loaded, GlobalInterests globalInterests) {
+    char buffer[1024];
+    snprintf(buffer, sizeof(buffer), "%s/data.dat", loaded->directory);
     FILE *fp = fopen(buffer,"r");
     if (!fp) {
-        return NULL;
+        return 0;
     }
-    int id = 0;
     char username[256];
     char password[256];
     char name[256];
-    int popularity;
-    float friendliness;
     char category_buf[256];
-    InterestTable tempInterests = init_user_interests(globalInterests);
-    UserPosts posts = create_empty_userPosts();
+    loaded->interests = init_user_interests(globalInterests);
+    loaded->posts = create_empty_userPosts();
     
-    if (fscanf(fp, "%d", &id)==0) exit(EXIT_FAILURE);
+    if (fscanf(fp, "%d", &loaded->id)==0) exit(EXIT_FAILURE);
     if (fscanf(fp, "%255s", username)==0) exit(EXIT_FAILURE);
     if (fscanf(fp, "%255s", password)==0) exit(EXIT_FAILURE);
     fgetc(fp);
     if (fgets(name, sizeof(name), fp) == NULL) exit(EXIT_FAILURE);
     name[strcspn(name, "\n")] = '\0';
-    if (fscanf(fp, "%d", &popularity)==0) exit(EXIT_FAILURE);
-    if (fscanf(fp, "%f", &friendliness)==0) exit(EXIT_FAILURE);
+    if (fscanf(fp, "%d", &loaded->popularity)==0) exit(EXIT_FAILURE);
+    if (fscanf(fp, "%f", &loaded->friendliness)==0) exit(EXIT_FAILURE);
     fgetc(fp);
     if (fgets(category_buf, sizeof(category_buf), fp) == NULL) exit(EXIT_FAILURE);
     category_buf[strcspn(category_buf, "\n")] = '\0';
 
     /* carga intereses*/
-    int i = 0;
-    while (fscanf(fp, "%d", &tempInterests[i].value) == 1 && i<globalInterests.numInterests-1) {
-        tempInterests[i].name = globalInterests.interestsTable[i];
-        i++;
+    int value;
+    for (int i = 0; i < globalInterests.numInterests && fscanf(fp, "%d", &value) == 1; i++) {
+        if (value == 1) set_interest(loaded->interests, i);
     }
     fclose(fp);
+
+    loaded->username = arena_strdup(username);
+    loaded->password = arena_strdup(password);
+    loaded->name = arena_strdup(name);
+    loaded->category = arena_strdup(category_buf);
     
     /* carga publicaciones */
-    snprintf(buffer, sizeof(buffer), "%s/posts", filename);
+    snprintf(buffer, sizeof(buffer), "%s/posts", loaded->directory);
     DIR *dir = opendir(buffer);
     if (!dir) {
-        return NULL;
+        return 0;
     }
    
     const struct dirent *entry;
     while ((entry = readdir(dir)) != NULL) {
         if (strcmp(entry->d_name, ".")==0 || strcmp(entry->d_name, "..")==0) continue;
-        char path[512];
-        snprintf(path, sizeof(path), "%s/posts/%s", filename, entry->d_name);
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/posts/%s", loaded->directory, entry->d_name);
         fp = fopen(path, "r"); 
         if (!fp) {
             continue;
@@ -254,108 +448,272 @@ User load_user_from_file(const char *filename, PtrToHashTable table, Graph graph
         if (fgets(post_content, sizeof(post_content), fp)==0) exit(EXIT_FAILURE);
         post_content[strcspn(post_content, "\n")] = '\0';
         fclose(fp);
-        insert_post(posts, post_content);
-        posts->next->id = post_id;
-        posts->next->date = post_date;
+        insert_post(loaded->posts, post_content);
+        loaded->posts->next->id = post_id;
+        loaded->posts->next->date = post_date;
     }
     closedir(dir);
 
-    User newUser = create_new_user(username, password, name, table, graph, globalInterests);
-    if (!newUser) {
-        printf("ERROR: No se pudo crear el usuario %s\n", username);
-        exit(EXIT_FAILURE);
+    /* seguidos (las conexiones se crean cuando ya existen todos los usuarios) */
+    snprintf(buffer, sizeof(buffer), "%s/following.dat", loaded->directory);
+    fp = fopen(buffer, "r");
+    if (fp) {
+        int capacity = 0;
+        char user2[256];
+        while (fscanf(fp, "%255s", user2) == 1) {
+            if (loaded->numFollowing == capacity) {
+                capacity = capacity ? capacity * 2 : 16;
+                char **grown = (char **)realloc(loaded->following, capacity * sizeof(char *));
+                if (!grown) {
+                    printf("ERROR: No hay memoria suficiente\n");
+                    exit(EXIT_FAILURE);
+                }
+                loaded->following = grown;
+            }
+            loaded->following[loaded->numFollowing] = strdup(user2);
+            if (!loaded->following[loaded->numFollowing]) {
+                printf("ERROR: No hay memoria suficiente\n");
+                exit(EXIT_FAILURE);
+            }
+            loaded->numFollowing++;
+        }
+        fclose(fp);
     }
+    return 1;
+}
+
+/**
+ * @brief Agrega a la tabla hash y al grafo un usuario leído con @see read_user_directory
+ *
+ * @param loaded Usuario leído (sus datos pasan al usuario creado)
+ * @param table Tabla hash de usuarios
+ * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ * @return User Usuario creado o NULL si el nombre de usuario ya existe
+ */
+static User add_loaded_user(struct _loadedUser *loaded, PtrToHashTable table, Graph graph, GlobalInterests globalInterests) {
+    User newUser = create_user_from_data(loaded->username, loaded->password, loaded->name, loaded->interests, table, graph);
+    if (!newUser) return NULL;
 
-    newUser->id = id;
-    newUser->popularity = popularity;
-    newUser->interests = tempInterests;
-    newUser->posts = posts;
-    newUser->friendliness = friendliness;
-    newUser->category = strdup(category_buf);
+    assign_user_id(graph, newUser, loaded->id);
+    newUser->popularity = loaded->popularity;
+    index_user_interests(graph, newUser, globalInterests);
+    pool_free(POOL_POSTS, newUser->posts);
+    newUser->posts = loaded->posts;
+    newUser->friendliness = loaded->friendliness;
+    newUser->category = loaded->category;
+    loaded->user = newUser;
     return newUser;
 }
 
 /**
- * @brief Carga todos los usuarios desde la base de datos.
+ * @brief Libera lo que queda de un usuario leído después de juntar los resultados
+ *
+ * @param loaded Usuario leído
+ */
+static void free_loaded_user(struct _loadedUser *loaded) {
+    for (int i = 0; i < loaded->numFollowing; i++) {
+        free(loaded->following[i]);
+    }
+    free(loaded->following);
+    free(loaded->followingUsers);
+    free(loaded->weights);
+    free(loaded->directory);
+}
+
+/**
+ * @brief Carga un usuario desde un archivo
  * 
+ * @param filename Nombre del archivo
  * @param table Tabla hash de usuarios
  * @param graph Grafo de usuarios
  * @param globalInterests Tabla de intereses globales
+ * @return User Usuario cargado
+ *
+ * @note No carga sus conexiones, @see load_all_users
  */
-void load_all_users(PtrToHashTable table, Graph graph, GlobalInterests globalInterests){
-    DIR *dir = opendir("database");
-    if (!dir) {
-        perror("ERROR: No se pudo abrir el directorio database");
-        return; 
+User load_user_from_file(const char *filename, PtrToHashTable table, Graph graph, GlobalInterests globalInterests) {
+    struct _loadedUser loaded = {0};
+    loaded.directory = strdup(filename);
+    if (!loaded.directory) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    User newUser = NULL;
+    if (read_user_directory(&loaded, globalInterests)) {
+        newUser = add_loaded_user(&loaded, table, graph, globalInterests);
+        if (!newUser) {
+            printf("ERROR: No se pudo crear el usuario %s\n", loaded.username);
+            exit(EXIT_FAILURE);
+        }
     }
+    free_loaded_user(&loaded);
+    return newUser;
+}
 
-    const struct dirent *entry;
-    while ((entry = readdir(dir)) != NULL) {
-        if (strcmp(entry->d_name, ".")==0 || strcmp(entry->d_name, "..")==0) continue;
+/**
+ * @brief Hilo del cargador: lee carpetas de usuarios hasta terminar
+ *
+ * @param arg Puntero a struct _loadJob
+ * @return void* NULL
+ *
+ * @note Los usuarios, publicaciones y strings se reservan de bloques propios del hilo (@see allocator_cache_begin), así los
+ *       hilos no se turnan en los locks del allocator; se juntan después de terminar todos
+ */
+static void *load_users_worker(void *arg) {
+    struct _loadJob *job = (struct _loadJob *)arg;
+    const int block = 16;
+    allocator_cache_begin(&job->caches[__atomic_fetch_add(&job->numCaches, 1, __ATOMIC_RELAXED)]);
+    while (1) {
+        int start = __atomic_fetch_add(&job->nextUser, block, __ATOMIC_RELAXED);
+        if (start >= job->numUsers) break;
+        int end = start + block < job->numUsers ? start + block : job->numUsers;
+        for (int i = start; i < end; i++) {
+            job->users[i].loaded = read_user_directory(&job->users[i], job->globalInterests);
+        }
+    }
+    allocator_cache_end();
+    return NULL;
+}
 
-        char path[1024];
-        
-        snprintf(path, sizeof(path), "database/%s", entry->d_name);
-        User user = load_user_from_file(path, table, graph, globalInterests);
-        if(!user){
-            printf("ERROR: No se pudo cargar el usuario %s\n", entry->d_name);
-            exit(EXIT_FAILURE);
+/**
+ * @brief Hilo del cargador: busca los usuarios seguidos y calcula el peso de cada conexión
+ *
+ * @param arg Puntero a struct _loadJob
+ * @return void* NULL
+ *
+ * @note Solo lee la tabla hash y los intereses, las aristas se enlazan después en un solo hilo
+ */
+static void *load_connections_worker(void *arg) {
+    struct _loadJob *job = (struct _loadJob *)arg;
+    const int block = 64;
+    while (1) {
+        int start = __atomic_fetch_add(&job->nextUser, block, __ATOMIC_RELAXED);
+        if (start >= job->numUsers) break;
+        int end = start + block < job->numUsers ? start + block : job->numUsers;
+        for (int i = start; i < end; i++) {
+            struct _loadedUser *loaded = &job->users[i];
+            if (!loaded->user || loaded->numFollowing == 0) continue;
+            loaded->followingUsers = (User *)malloc(loaded->numFollowing * sizeof(User));
+            loaded->weights = (double *)malloc(loaded->numFollowing * sizeof(double));
+            if (!loaded->followingUsers || !loaded->weights) {
+                printf("ERROR: No hay memoria suficiente\n");
+                exit(EXIT_FAILURE);
+            }
+            for (int f = 0; f < loaded->numFollowing; f++) {
+                User target = search_user(loaded->following[f], job->table);
+                if (target == loaded->user) target = NULL;
+                loaded->followingUsers[f] = target;
+                loaded->weights[f] = target ? edge_jaccard(loaded->user, target, job->globalInterests) : 0;
+            }
         }
-        
     }
-    
-    closedir(dir);
-    
+    return NULL;
+}
+
+/**
+ * @brief Ejecuta una etapa del cargador con varios hilos
+ *
+ * @param job Datos compartidos
+ * @param worker Función de cada hilo
+ *
+ * @note Leer archivos bloquea, así que se usan hasta el doble de hilos que núcleos
+ */
+static void run_load_workers(struct _loadJob *job, void *(*worker)(void *)) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    long wanted = cores < 1 ? 1 : cores * 2;
+    int numThreads = wanted > DATABASE_LOAD_MAX_THREADS ? DATABASE_LOAD_MAX_THREADS : (int)wanted;
+    if (numThreads > job->numUsers) numThreads = job->numUsers;
+    pthread_t threads[DATABASE_LOAD_MAX_THREADS];
+    int started = 0;
+    job->nextUser = 0;
+    for (int t = 0; t < numThreads; t++) {
+        if (pthread_create(&threads[t], NULL, worker, job) != 0) break;
+        started++;
+    }
+    if (started == 0) worker(job);
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
 }
 
 /**
- * @brief Carga todas las conexiones (aristas) de los usuarios desde la base de datos.
- * @note Es necesario que se haya cargado los usuarios con @see load_all_users antes de llamar a esta función.
+ * @brief Carga todos los usuarios y sus conexiones desde la base de datos.
  * 
  * @param table Tabla hash de usuarios
+ * @param graph Grafo de usuarios
  * @param globalInterests Tabla de intereses globales
+ *
+ * @note Las carpetas se leen con varios hilos y luego se agregan en orden a la tabla hash y al grafo. Las conexiones se
+ *       resuelven con varios hilos cuando ya existen todos los usuarios y se enlazan en un solo hilo
  */
-void load_connections(PtrToHashTable table, GlobalInterests globalInterests){
+void load_all_users(PtrToHashTable table, Graph graph, GlobalInterests globalInterests){
     DIR *dir = opendir("database");
     if (!dir) {
+        perror("ERROR: No se pudo abrir el directorio database");
         return; 
     }
+
+    struct _loadJob job;
+    job.users = NULL;
+    job.numUsers = 0;
+    job.numCaches = 0;
+    job.table = table;
+    job.globalInterests = globalInterests;
+    int capacity = 0;
+
     const struct dirent *entry;
     while ((entry = readdir(dir)) != NULL) {
-        if (strcmp(entry->d_name, ".")==0 || strcmp(entry->d_name, "..")==0) continue;
-        char path[512];
-        /* rescatar usuario */
-        snprintf(path, sizeof(path), "database/%s/data.dat", entry->d_name);
-        FILE *fp = fopen(path, "r");
-        if (!fp) {
-            continue;
+        if (!is_user_directory(entry->d_name)) continue;
+        if (job.numUsers == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            struct _loadedUser *grown = (struct _loadedUser *)realloc(job.users, capacity * sizeof(struct _loadedUser));
+            if (!grown) {
+                printf("ERROR: No hay memoria suficiente\n");
+                exit(EXIT_FAILURE);
+            }
+            job.users = grown;
         }
-        char username[256];
-        for(int i=0; i<2; i++){
-            if(fscanf(fp, "%255s", username)==0) exit(EXIT_FAILURE);
+        struct _loadedUser *loaded = &job.users[job.numUsers++];
+        memset(loaded, 0, sizeof(*loaded));
+        size_t length = strlen(entry->d_name) + sizeof("database/");
+        loaded->directory = (char *)malloc(length);
+        if (!loaded->directory) {
+            printf("ERROR: No hay memoria suficiente\n");
+            exit(EXIT_FAILURE);
         }
-       
+        snprintf(loaded->directory, length, "database/%s", entry->d_name);
+    }
+    closedir(dir);
+    load_next_id(graph);
+    if (job.numUsers == 0) {
+        free(job.users);
+        return;
+    }
 
-        User currentUser=search_user(username, table);
-        
-        if(!currentUser){
-            printf("ERROR: No se pudo cargar el usuario %s\n", username);
+    /* leer carpetas */
+    run_load_workers(&job, load_users_worker);
+    for (int t = 0; t < job.numCaches; t++) allocator_cache_merge(&job.caches[t]);
+
+    /* juntar en el orden del directorio */
+    for (int i = 0; i < job.numUsers; i++) {
+        struct _loadedUser *loaded = &job.users[i];
+        if (!loaded->loaded || !add_loaded_user(loaded, table, graph, globalInterests)) {
+            printf("ERROR: No se pudo cargar el usuario %s\n", loaded->directory + strlen("database/"));
             exit(EXIT_FAILURE);
         }
-        fclose(fp);
+    }
 
-        /* following */
-        snprintf(path, sizeof(path), "database/%s/following.dat", entry->d_name);
-        fp = fopen(path, "r");
-        if (!fp) {
-            continue;
+    /* conexiones */
+    run_load_workers(&job, load_connections_worker);
+    for (int i = 0; i < job.numUsers; i++) {
+        struct _loadedUser *loaded = &job.users[i];
+        for (int f = 0; f < loaded->numFollowing; f++) {
+            if (loaded->followingUsers[f]) add_edge_with_weight(loaded->user, loaded->followingUsers[f], loaded->weights[f]);
         }
-        char user2[256];
-        while(fscanf(fp, "%255s", user2)!=EOF){
-            add_edge(currentUser, search_user(user2, table), globalInterests);
-        }
-        fclose(fp);
+        free_loaded_user(loaded);
     }
+    free(job.users);
 }
 
 /**
@@ -364,10 +722,47 @@ void load_connections(PtrToHashTable table, GlobalInterests globalInterests){
  * @param table Tabla hash de usuarios
  * @param graph Grafo de usuarios
  * @param globalInterests Tabla de intereses globales
+ *
+ * @note Si existe DATABASE_SNAPSHOT_FILE se carga desde ahí y se aplican los cambios del WAL; si no, desde las carpetas de cada usuario
  */
 void load_database(PtrToHashTable table, Graph graph, GlobalInterests globalInterests){
-    load_all_users(table, graph, globalInterests);
-    load_connections(table, globalInterests);
+    struct stat st = {0};
+    if (stat(DATABASE_SNAPSHOT_FILE, &st) == 0) {
+        load_snapshot(table, graph, globalInterests, DATABASE_SNAPSHOT_FILE);
+        snapshotMode = 1;
+        replay_wal(table, graph, globalInterests);
+    }
+    else {
+        load_all_users(table, graph, globalInterests);
+    }
+    /* lo recién cargado ya está guardado */
+    PtrToUser currentUser = graph->graphUsersList->next;
+    while (currentUser) {
+        currentUser->dirty = 0;
+        currentUser->savedPosts = currentUser->posts->id;
+        currentUser = currentUser->next;
+    }
+}
+
+/**
+ * @brief Escribe los cambios pendientes de la base de datos
+ *
+ * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ *
+ * @note Con las carpetas de usuarios se guardan los usuarios que quedaron con cambios (@see save_dirty_users). Con el snapshot se
+ *       escriben juntos los registros del WAL acumulados y, si el WAL creció más de WAL_COMPACT_SIZE, se incorpora al snapshot
+ */
+void flush_database(Graph graph, GlobalInterests globalInterests){
+    if (!snapshotMode) {
+        save_dirty_users(graph, globalInterests);
+        return;
+    }
+    write_wal();
+    struct stat st = {0};
+    if (!lazyDatabase && stat(WAL_FILE, &st) == 0 && st.st_size > WAL_COMPACT_SIZE) {
+        fold_wal_into_snapshot(graph, globalInterests);
+    }
 }
 
 /**
@@ -402,47 +797,59 @@ User current_session(PtrToHashTable graph) {
  * @brief Inicia sesión
  * 
  * @param graph Grafo de usuarios
+ * @return int 0 si se inicia la sesión, -1 si falta la entrada o los datos no son correctos
  * @note Se guarda el usuario actual en "current.dat"
  */
-void login(PtrToHashTable graph) {
-    FILE *file = fopen("current.dat","w");
-    if (!file) {
-        printf("ERROR: No se pudo iniciar sesión.\n");
-        return;
-    }
-
+int login(PtrToHashTable graph) {
     print_logo();
 
     // leer usuario y contraseña
     char *username=malloc(sizeof(char)*256);
     char *password=malloc(sizeof(char)*256);
     printf("Ingrese su nombre de usuario: ");
-    if (scanf("%255s",username)==0) exit(EXIT_FAILURE);
+    if (scanf("%255s",username)!=1) {
+        printf("\nERROR: No se ingresó el nombre de usuario.\n");
+        free(username);
+        free(password);
+        return -1;
+    }
     printf("Ingrese su contraseña: ");
-    if (scanf("%255s",password)==0) exit(EXIT_FAILURE);
+    if (scanf("%255s",password)!=1) {
+        printf("\nERROR: No se ingresó la contraseña.\n");
+        free(username);
+        free(password);
+        return -1;
+    }
 
     User user = search_user(username, graph);
     if (!user) {
         printf(COLOR_RED COLOR_BOLD"ERROR: Usuario no existe. Intente nuevamente\n"COLOR_RESET);
         free(username);
         free(password);
-        fclose(file);
-        return;
+        return -1;
     }
 
     if (strcmp(user->password, password) != 0) {
         printf("ERROR: Contraseña incorrecta.\n");
-        fclose(file);
         free(username);
         free(password);
-        return;
+        return -1;
     }
 
+    /* la sesión anterior solo se reemplaza con un inicio de sesión correcto */
+    FILE *file = fopen("current.dat","w");
+    if (!file) {
+        printf("ERROR: No se pudo iniciar sesión.\n");
+        free(username);
+        free(password);
+        return -1;
+    }
     fprintf(file,"%s",username);
     printf("Sesión iniciada correctamente como '%s'.\n", username);
     free(username);
     free(password);
     fclose(file);
+    return 0;
 }
 
 /**
@@ -462,40 +869,56 @@ void logout(void) {
  * @param table Tabla hash de usuarios
  * @param graph Grafo de usuarios
  * @param globalInterests Tabla de intereses globales
- * 
+ * @return int 0 si se registra, -1 si falta la entrada
  */
-void register_user(PtrToHashTable table, Graph graph, GlobalInterests globalInterests) {
+int register_user(PtrToHashTable table, Graph graph, GlobalInterests globalInterests) {
 
     print_logo();
 
     char *username=malloc(sizeof(char)*256);
+    char *password=malloc(sizeof(char)*256);
     printf("Ingrese su nombre de usuario: ");
-    if (scanf("%255s",username)==0) exit(EXIT_FAILURE);
-    User user = search_user(username, table);
-    while(user) {
+    int scanned = scanf("%255s",username);
+    User user = scanned == 1 ? search_user(username, table) : NULL;
+    while(scanned == 1 && user) {
         printf(COLOR_RED COLOR_BOLD"ERROR: El nombre de usuario '%s' ya existe. Intente con otro usuario: \n"COLOR_RESET, username);
-        if (scanf("%255s",username)==0) exit(EXIT_FAILURE);
-        user = search_user(username, table);
+        scanned = scanf("%255s",username);
+        user = scanned == 1 ? search_user(username, table) : NULL;
+    }
+    if (scanned == 1) {
+        printf("Ingrese su contraseña: ");
+        scanned = scanf("%255s",password);
+    }
+    if (scanned != 1) {
+        printf("\nERROR: Registro cancelado, faltan datos.\n");
+        free(username);
+        free(password);
+        return -1;
     }
-
-    char *password=malloc(sizeof(char)*256);
-    printf("Ingrese su contraseña: ");
-    if (scanf("%255s",password)==0) exit(EXIT_FAILURE);
 
     int c;
     while ((c = getchar()) != '\n' && c != EOF); // limpiar buffer
     char *name=malloc(sizeof(char)*256);
     printf("Ingrese su nombre: ");
-    if (fgets(name, 256, stdin) != NULL) {
-        size_t len = strlen(name);
-        if (len > 0 && name[len - 1] == '\n') {
-            name[len - 1] = '\0';
-        }
+    if (fgets(name, 256, stdin) == NULL) {
+        printf("\nERROR: Registro cancelado, faltan datos.\n");
+        free(username);
+        free(password);
+        free(name);
+        return -1;
+    }
+    size_t len = strlen(name);
+    if (len > 0 && name[len - 1] == '\n') {
+        name[len - 1] = '\0';
     }
 
     user = create_new_user(username, password, name, table, graph, globalInterests);
     if(!user){
         printf(COLOR_RED COLOR_BOLD"ERROR: No se pudo crear el usuario '%s'.\n"COLOR_RESET, username);
+        free(username);
+        free(password);
+        free(name);
+        return -1;
     }
     free(username);
     free(password);
@@ -505,18 +928,21 @@ void register_user(PtrToHashTable table, Graph graph, GlobalInterests globalInte
     print_global_interests(globalInterests);
     int option;
     do {
-        if (scanf("%d",&option)==0) exit(EXIT_FAILURE);
+        /* el usuario ya existe: si la entrada se acaba se registra con los intereses ingresados hasta ahí */
+        if (scanf("%d",&option)!=1) break;
         if(option<0 || option>=globalInterests.numInterests-1){
             printf(COLOR_RED COLOR_BOLD"ERROR: ID de interes no válido. Intente nuevamente\n"COLOR_RESET);
         }
         else if(option>0){
-            add_interest(user, globalInterests, option);
+            add_interest(user, graph, globalInterests, option);
             printf("Se ha añadido el interes %s.\n", globalInterests.interestsTable[option]);
         }
     } while(option != 0);
 
     save_user_data(user, globalInterests);
+    append_wal_register(user, globalInterests);
     printf("Usuario registrado correctamente. Ahora puedes iniciar sesión y conectar con otros usuarios.\n");
+    return 0;
 }
 
 /**
@@ -524,25 +950,31 @@ void register_user(PtrToHashTable table, Graph graph, GlobalInterests globalInte
  * 
  * @param user Usuario publicador
  * @param globalInterests Tabla de intereses globales
+ * @return int 0 si se publica, -1 si falta el contenido
  * 
  * @note Se guarda la publicación en la carpeta "database/{username}_data/posts"
  */
-void write_post(User user, GlobalInterests globalInterests) {
+int write_post(User user, GlobalInterests globalInterests) {
     print_logo();
     printf(COLOR_RED COLOR_BOLD"Publicando como '%s'. Escriba el contenido de la publicación:\n\n"COLOR_RESET, user->username);
     printf("-----------------------------------------------------------------------------\n");
     char *content=malloc(sizeof(char)*1028);
-    if (fgets(content, 512, stdin) != NULL) {
-        size_t len = strlen(content);
-        if (len > 0 && content[len-1] == '\n') {
-            content[len-1] = '\0';
-        }
+    if (fgets(content, 512, stdin) == NULL) {
+        printf("ERROR: No se ingresó el contenido de la publicación.\n");
+        free(content);
+        return -1;
+    }
+    size_t len = strlen(content);
+    if (len > 0 && content[len-1] == '\n') {
+        content[len-1] = '\0';
     }
     printf("-----------------------------------------------------------------------------\n");
-    insert_post(user->posts, content);
+    PtrToPostNode post = insert_post(user->posts, content);
     save_user_data(user, globalInterests);
+    append_wal_post(user, post);
     free(content);
     printf("Publicación creada correctamente.\n");
+    return 0;
 }
 
 /**
@@ -552,18 +984,30 @@ void write_post(User user, GlobalInterests globalInterests) {
  * @param follow Nombre del usuario que se va a seguir
  * @param globalInterests Tabla de intereses globales
  * @param table Tabla hash de usuarios
+ * @return int 0 si lo sigue (o ya lo seguía), -1 si el usuario no existe o es el mismo
  * 
  * @note Esta información se guarda en la carpeta "database/{user}_data/following.dat"
  */
-void follow(User user, char* follow, GlobalInterests globalInterests, PtrToHashTable table) {
+int follow(User user, char* follow, GlobalInterests globalInterests, PtrToHashTable table) {
     User to_follow = search_user(follow, table);
     if(!to_follow){
         printf("ERROR: Usuario '%s' no encontrado.\n", follow);
-        return;
+        return -1;
+    }
+    /* add_edge ignora a un usuario que se sigue a sí mismo; aquí se avisa */
+    if (to_follow == user) {
+        printf("ERROR: No puedes seguirte a ti mismo.\n");
+        return -1;
+    }
+    if (!add_edge(user, to_follow, globalInterests)) {
+        printf("Ya sigues a '%s'.\n", to_follow->username);
+        return 0;
     }
-    add_edge(user, to_follow, globalInterests);
     save_user_data(user, globalInterests);
+    save_user_data(to_follow, globalInterests);
+    append_wal_record(WAL_FOLLOW, user, &to_follow->id, sizeof(int));
     printf("Ahora sigues a '%s'.\n", to_follow->username);
+    return 0;
 }
 
 /**
@@ -573,61 +1017,90 @@ void follow(User user, char* follow, GlobalInterests globalInterests, PtrToHashT
  * @param follow Nombre del usuario que ya no se va a seguir
  * @param globalInterests Tabla de intereses globales
  * @param table Tabla hash de usuarios
+ * @return int 0 si ya no lo sigue, -1 si el usuario no existe
  * 
  * @note Esta información se guarda en la carpeta "database/{user}_data/followers.dat"
  */
-void unfollow(User user, char* follow, GlobalInterests globalInterests, PtrToHashTable table) {
+int unfollow(User user, char* follow, GlobalInterests globalInterests, PtrToHashTable table) {
     User to_unfollow = search_user(follow, table);
     if(!to_unfollow){
         printf("ERROR: '%s' no es un usuario que exista.\n", follow);
-        return;
+        return -1;
     }
     // Llamada a remove_edge
-    remove_edge(user, to_unfollow);
+    if (!remove_edge(user, to_unfollow)) {
+        printf("No sigues a '%s'.\n", to_unfollow->username);
+        return 0;
+    }
     // Guardar datos
     save_user_data(user, globalInterests);
+    save_user_data(to_unfollow, globalInterests);
+    append_wal_record(WAL_UNFOLLOW, user, &to_unfollow->id, sizeof(int));
     printf("Has dejado de seguir a '%s'.\n", to_unfollow->username);
+    return 0;
 }
 
 /**
  * @brief Borrar la cuenta de un usuario de la base de datos
  * 
  * @param user Usuario a borrar
+ * @param table Tabla hash de usuarios
+ * @param graph Grafo de usuarios
  * 
- * @note Se borran todos los archivos de la carpeta "database/{user}_data" y la misma carpeta
+ * @note El usuario se saca de memoria en ambos modos, así un servidor o un lote no lo vuelven a encontrar ni a guardar. Con
+ *       carpetas se borran todos los archivos de "database/{user}_data" y la misma carpeta, y los usuarios que lo seguían o
+ *       seguía se reescriben al guardar; con el snapshot se registra en el WAL
  */
-void delete_account(User user) {
-    char path[512];
-    snprintf(path, sizeof(path), "database/%s_data/data.dat", user->username);
-    remove(path);
-    snprintf(path, sizeof(path), "database/%s_data/following.dat", user->username);
-    remove(path);
-    snprintf(path, sizeof(path), "database/%s_data/followers.dat", user->username);
-    remove(path);
-    snprintf(path, sizeof(path), "database/%s_data/posts", user->username);
-    delete_all_in_directory(path);
-    rmdir(path);
-    snprintf(path, sizeof(path), "database/%s_data", user->username);
-    rmdir(path);
+void delete_account(User user, PtrToHashTable table, Graph graph) {
     printf("Se ha borrado la cuenta de '%s' exitosamente.\n", user->username);
+    if (snapshotMode) {
+        append_wal_record(WAL_DELETE, user, NULL, 0);
+    }
+    else {
+        remove_user_directory(user->username);
+    }
+    delete_user(user, table, graph);
+    if (!snapshotMode) save_next_id(graph);
     logout();
 }
 
+/**
+ * @brief Copia con malloc un string que reemplaza a otro de un usuario
+ *
+ * @param string String a copiar
+ * @return char* Copia, se libera con @see free_database_memory
+ *
+ * @note Los strings editados no van a la arena: ahí solo se devuelven bloques completos, y el servidor iría acumulando los
+ *       strings reemplazados (@see struct _stringArena)
+ */
+static char *copy_edited_string(const char *string){
+    char *copy = strdup(string);
+    if (!copy) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    return copy;
+}
+
 /**
  * @brief Permite a un usuario editar la información de su cuenta
  * 
  * @param user Sesión iniciada
  * @param globalInterests Tabla de intereses globales
  * @param table Tabla de usuarios
+ * @return int 0 si se modifica la cuenta, -1 si falta la entrada o el nuevo nombre de usuario ya existe
  */
-void edit_account(User user, GlobalInterests globalInterests, PtrToHashTable table) {
+int edit_account(User user, GlobalInterests globalInterests, PtrToHashTable table) {
     
     printf("Qué información de su cuenta desea modificar?\n");
     printf("1. Nombre\n2. Usuario\n3. Contraseña\n");
     int option;
 
     do {
-        if (scanf("%d",&option)==0) exit(EXIT_FAILURE);
+        if (scanf("%d",&option)!=1) {
+            printf("ERROR: No se ingresó una opción.\n");
+            return -1;
+        }
         if(option<0 || option>3){
             printf("ERROR: Opción inválida. Intente nuevamente\n");
         }
@@ -637,30 +1110,67 @@ void edit_account(User user, GlobalInterests globalInterests, PtrToHashTable tab
         case 1: 
             printf("Ingrese el nuevo nombre: ");
             char *new_name=malloc(sizeof(char)*256);
-            while (getchar() != '\n');
-            if (fgets(new_name, 256, stdin) != NULL) {
-                size_t len = strlen(new_name);
-                if (len > 0 && new_name[len - 1] == '\n') {
-                    new_name[len - 1] = '\0';
-                }
+            int c;
+            while ((c = getchar()) != '\n' && c != EOF); // limpiar buffer
+            if (fgets(new_name, 256, stdin) == NULL) {
+                printf("\nERROR: No se ingresó el nombre.\n");
+                free(new_name);
+                return -1;
             }
-            free(user->name);
-            user->name = strdup(new_name);
+            size_t len = strlen(new_name);
+            if (len > 0 && new_name[len - 1] == '\n') {
+                new_name[len - 1] = '\0';
+            }
+            free_database_memory(user->name);
+            user->name = copy_edited_string(new_name);
+            user->dirty |= USER_DIRTY_PROFILE;
+            append_wal_record(WAL_EDIT_NAME, user, user->name, strlen(user->name) + 1);
             printf("Se ha modificado su nombre a '%s'.\n", user->name);
             free(new_name);
             break;
         case 2:
             printf("Ingrese el nuevo usuario: ");
             char *new_username=malloc(sizeof(char)*256);
-            if (scanf("%255s",new_username)==0) exit(EXIT_FAILURE);
+            if (scanf("%255s",new_username)!=1) {
+                printf("\nERROR: No se ingresó el nombre de usuario.\n");
+                free(new_username);
+                return -1;
+            }
             User user_aux = search_user(new_username, table);
             if(user_aux){
                 printf("ERROR: El nombre de usuario '%s' ya existe. Intente nuevamente \n", new_username);
                 free(new_username);
-                return;
+                return -1;
             }
-            free(user->username);
-            user->username = strdup(new_username);
+            delete_from_hash_table(table, user->username);
+            char *old_username = user->username;
+            user->username = copy_edited_string(new_username);
+            insert_into_hash_table(table, user->username, user);
+            if (!snapshotMode) {
+                /* la carpeta cambia de nombre y los vecinos guardan el nombre de usuario en sus listas */
+                user->dirty = USER_DIRTY_ALL;
+                user->savedPosts = 0;
+                save_user_data(user, globalInterests);
+                for (int i = 0; i < user->following->size; i++) {
+                    User dest = user->following->edges[i].dest;
+                    dest->dirty |= USER_DIRTY_FOLLOWERS;
+                    save_user_data(dest, globalInterests);
+                }
+                for (int i = 0; i < user->followers->size; i++) {
+                    User dest = user->followers->edges[i].dest;
+                    dest->dirty |= USER_DIRTY_FOLLOWING;
+                    save_user_data(dest, globalInterests);
+                }
+                remove_user_directory(old_username);
+            }
+            free_database_memory(old_username);
+            /* la sesión guarda el nombre de usuario */
+            FILE *session = fopen("current.dat","w");
+            if (session) {
+                fprintf(session,"%s",user->username);
+                fclose(session);
+            }
+            append_wal_record(WAL_EDIT_USERNAME, user, user->username, strlen(user->username) + 1);
             printf("Se ha modificado su nombre de usuario a '%s'.\n", user->username);
             free(new_username);
             break;
@@ -668,14 +1178,21 @@ void edit_account(User user, GlobalInterests globalInterests, PtrToHashTable tab
         case 3:
             printf("Ingrese la nueva contraseña: ");
             char *new_password=malloc(sizeof(char)*256);
-            if (scanf("%255s",new_password)==0) exit(EXIT_FAILURE);
-            free(user->password);
-            user->password = strdup(new_password);
+            if (scanf("%255s",new_password)!=1) {
+                printf("\nERROR: No se ingresó la contraseña.\n");
+                free(new_password);
+                return -1;
+            }
+            free_database_memory(user->password);
+            user->password = copy_edited_string(new_password);
+            user->dirty |= USER_DIRTY_PROFILE;
+            append_wal_record(WAL_EDIT_PASSWORD, user, user->password, strlen(user->password) + 1);
             printf("Se ha modificado su contraseña a '%s'.\n", user->password);
             free(new_password);
             break;
     }
     save_user_data(user, globalInterests);
+    return 0;
 }
 
 /**
@@ -691,4 +1208,975 @@ void generate_database(int quantity, PtrToHashTable table, Graph graph, GlobalIn
     generate_random_connections(graph, globalInterests);
     generate_posts_for_everyone(graph, globalInterests);
     save_all_users(graph, globalInterests);
-}
\ No newline at end of file
+}
+/* SNAPSHOT */
+
+/**
+ * @struct _stringTable
+ * @brief Tabla de strings del snapshot mientras se construye
+ */
+struct _stringTable{
+    char *data; /*!< Strings seguidos, cada uno terminado en '\0' */
+    long long size; /*!< Bytes usados */
+    long long capacity; /*!< Bytes reservados */
+};
+
+/**
+ * @brief Agrega un string a la tabla de strings del snapshot
+ *
+ * @param strings Tabla de strings
+ * @param string String a agregar (puede ser NULL)
+ * @return long long Posición del string en la tabla, -1 si es NULL
+ */
+static long long add_snapshot_string(struct _stringTable *strings, const char *string){
+    if (!string) return -1;
+    long long length = (long long)strlen(string) + 1;
+    if (strings->size + length > strings->capacity) {
+        long long capacity = strings->capacity ? strings->capacity * 2 : 4096;
+        while (capacity < strings->size + length) capacity *= 2;
+        char *data = (char *)realloc(strings->data, capacity);
+        if (!data) {
+            printf("ERROR: No hay memoria suficiente\n");
+            exit(EXIT_FAILURE);
+        }
+        strings->data = data;
+        strings->capacity = capacity;
+    }
+    memcpy(strings->data + strings->size, string, length);
+    long long offset = strings->size;
+    strings->size += length;
+    return offset;
+}
+
+/**
+ * @brief Escribe una sección del snapshot y la rellena con ceros hasta un múltiplo de 8 bytes
+ *
+ * @param fp Archivo
+ * @param data Datos de la sección
+ * @param bytes Tamaño de los datos
+ * @param position Posición actual en el archivo (se actualiza)
+ * @return long long Posición donde empieza la sección, -1 si falla la escritura
+ */
+static long long write_snapshot_section(FILE *fp, const void *data, size_t bytes, long long *position){
+    static const char padding[8] = {0};
+    long long start = *position;
+    if (bytes > 0 && fwrite(data, 1, bytes, fp) != bytes) return -1;
+    size_t extra = (8 - bytes % 8) % 8;
+    if (extra > 0 && fwrite(padding, 1, extra, fp) != extra) return -1;
+    *position += (long long)(bytes + extra);
+    return start;
+}
+
+/**
+ * @brief Escribe toda la base de datos en un archivo de snapshot
+ *
+ * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ * @param path Archivo de destino
+ * @return int 0 si se escribe correctamente, -1 si hay un error
+ *
+ * @note Se escribe primero en "{path}.tmp" y luego se renombra, así un corte a medio guardar no deja el snapshot incompleto.
+ *       @see struct _snapshotHeader para el formato
+ */
+int write_snapshot(Graph graph, GlobalInterests globalInterests, const char *path){
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.numUsers = graph->usersNumber;
+    header.numNodes = graph->nextId;
+    header.numInterests = globalInterests.numInterests;
+    header.numWords = globalInterests.numWords;
+    header.walGeneration = walGeneration;
+
+    for (User user = graph->graphUsersList->next; user; user = user->next) {
+        for (PtrToPostNode post = user->posts->next; post; post = post->next) header.numPosts++;
+    }
+
+    SnapshotUser *users = (SnapshotUser *)calloc((size_t)header.numUsers + 1, sizeof(SnapshotUser));
+    InterestWord *interests = (InterestWord *)malloc(((size_t)header.numUsers * header.numWords + 1) * sizeof(InterestWord));
+    SnapshotPost *posts = (SnapshotPost *)calloc((size_t)header.numPosts + 1, sizeof(SnapshotPost));
+    struct _stringTable strings = {NULL, 0, 0};
+    if (!users || !interests || !posts) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int index = 0;
+    long long postIndex = 0;
+    for (User user = graph->graphUsersList->next; user; user = user->next, index++) {
+        SnapshotUser *record = &users[index];
+        float friendliness = calculate_friendliness(user);
+        record->id = user->id;
+        record->popularity = user->popularity;
+        record->friendliness = friendliness;
+        record->username = add_snapshot_string(&strings, user->username);
+        record->password = add_snapshot_string(&strings, user->password);
+        record->name = add_snapshot_string(&strings, user->name);
+        record->category = add_snapshot_string(&strings, classify_friendliness(friendliness));
+        record->firstPost = postIndex;
+        memcpy(&interests[(size_t)index * header.numWords], user->interests, header.numWords * sizeof(InterestWord));
+
+        for (PtrToPostNode post = user->posts->next; post; post = post->next, postIndex++) {
+            SnapshotPost *postRecord = &posts[postIndex];
+            postRecord->id = post->id;
+            postRecord->year = post->date.tm_year;
+            postRecord->month = post->date.tm_mon;
+            postRecord->day = post->date.tm_mday;
+            postRecord->hour = post->date.tm_hour;
+            postRecord->minute = post->date.tm_min;
+            postRecord->second = post->date.tm_sec;
+            postRecord->weekDay = post->date.tm_wday;
+            postRecord->yearDay = post->date.tm_yday;
+            postRecord->isDst = post->date.tm_isdst;
+            postRecord->content = add_snapshot_string(&strings, post->post);
+            record->numPosts++;
+        }
+    }
+
+    CsrGraph csr = get_csr_graph(graph);
+    header.numEdges = csr->numEdges;
+    /* el encabezado guarda una sola cantidad de aristas para los seguidos y los seguidores */
+    int consistent = csr->numInEdges == csr->numEdges;
+    if (!consistent) {
+        printf("ERROR: Los seguidos (%d) y seguidores (%d) del grafo no coinciden\n", csr->numEdges, csr->numInEdges);
+    }
+
+    /* índices para la carga parcial: registro de cada id y nombres de usuario */
+    header.usernameIndexSize = 16;
+    while (header.usernameIndexSize < 2 * (long long)header.numUsers) header.usernameIndexSize *= 2;
+    int *usersById = (int *)malloc(((size_t)header.numNodes + 1) * sizeof(int));
+    int *usernameIndex = (int *)malloc((size_t)header.usernameIndexSize * sizeof(int));
+    if (!usersById || !usernameIndex) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(usersById, -1, ((size_t)header.numNodes + 1) * sizeof(int));
+    memset(usernameIndex, -1, (size_t)header.usernameIndexSize * sizeof(int));
+    index = 0;
+    for (User user = graph->graphUsersList->next; user; user = user->next, index++) {
+        usersById[user->id] = index;
+        long long mask = header.usernameIndexSize - 1;
+        long long slot = jenkins_hash(user->username) & mask;
+        while (usernameIndex[slot] != -1) slot = (slot + 1) & mask;
+        usernameIndex[slot] = index;
+    }
+
+    char tempPath[512];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+    FILE *fp = consistent ? fopen(tempPath, "wb") : NULL;
+    int error = !fp;
+    if (fp) {
+        long long position = 0;
+        error |= write_snapshot_section(fp, &header, sizeof(header), &position) < 0;
+        header.stringsOffset = write_snapshot_section(fp, strings.data, strings.size, &position);
+        header.stringsSize = strings.size;
+        header.usersOffset = write_snapshot_section(fp, users, (size_t)header.numUsers * sizeof(SnapshotUser), &position);
+        header.interestsOffset = write_snapshot_section(fp, interests, (size_t)header.numUsers * header.numWords * sizeof(InterestWord), &position);
+        header.edgeOffsetsOffset = write_snapshot_section(fp, csr->outOffsets, ((size_t)csr->numNodes + 1) * sizeof(int), &position);
+        header.edgeTargetsOffset = write_snapshot_section(fp, csr->outTargets, (size_t)csr->numEdges * sizeof(int), &position);
+        header.edgeWeightsOffset = write_snapshot_section(fp, csr->outWeights, (size_t)csr->numEdges * sizeof(double), &position);
+        header.postsOffset = write_snapshot_section(fp, posts, (size_t)header.numPosts * sizeof(SnapshotPost), &position);
+        header.usersByIdOffset = write_snapshot_section(fp, usersById, (size_t)header.numNodes * sizeof(int), &position);
+        header.usernameIndexOffset = write_snapshot_section(fp, usernameIndex, (size_t)header.usernameIndexSize * sizeof(int), &position);
+        header.followerOffsetsOffset = write_snapshot_section(fp, csr->inOffsets, ((size_t)csr->numNodes + 1) * sizeof(int), &position);
+        header.followerSourcesOffset = write_snapshot_section(fp, csr->inTargets, (size_t)csr->numEdges * sizeof(int), &position);
+        header.followerWeightsOffset = write_snapshot_section(fp, csr->inWeights, (size_t)csr->numEdges * sizeof(double), &position);
+        error |= header.stringsOffset < 0 || header.usersOffset < 0 || header.interestsOffset < 0 || header.edgeOffsetsOffset < 0 ||
+                 header.edgeTargetsOffset < 0 || header.edgeWeightsOffset < 0 || header.postsOffset < 0 ||
+                 header.usersByIdOffset < 0 || header.usernameIndexOffset < 0 || header.followerOffsetsOffset < 0 ||
+                 header.followerSourcesOffset < 0 || header.followerWeightsOffset < 0;
+        /* reescribir el encabezado con las posiciones de las secciones */
+        error |= fseek(fp, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, fp) != 1;
+        error |= fflush(fp) != 0 || fsync(fileno(fp)) != 0;
+        error |= fclose(fp) != 0;
+    }
+    if (!error) error = rename(tempPath, path) != 0;
+    if (error) {
+        printf("ERROR: No se pudo guardar el archivo '%s'\n", path);
+        remove(tempPath);
+    }
+
+    free(usersById);
+    free(usernameIndex);
+    free(strings.data);
+    free(users);
+    free(interests);
+    free(posts);
+    return error ? -1 : 0;
+}
+
+/**
+ * @brief Obtiene un string de la tabla de strings del snapshot
+ *
+ * @param buffer Contenido del snapshot
+ * @param header Encabezado del snapshot
+ * @param offset Posición del string en la tabla
+ * @return char* String o NULL si la posición es -1 o no es válida
+ */
+static char *snapshot_string(char *buffer, const SnapshotHeader *header, long long offset){
+    if (offset < 0 || offset >= header->stringsSize) return NULL;
+    return buffer + header->stringsOffset + offset;
+}
+
+/**
+ * @brief Verifica que una sección del snapshot esté dentro del archivo
+ *
+ * @param offset Inicio de la sección
+ * @param count Cantidad de elementos
+ * @param size Tamaño de cada elemento
+ * @param fileSize Tamaño del archivo
+ * @return int 1 si es válida
+ */
+static int valid_snapshot_section(long long offset, long long count, size_t size, long long fileSize){
+    return offset >= (long long)SNAPSHOT_V1_HEADER_SIZE && offset % 8 == 0 && count >= 0 &&
+           count <= (fileSize - offset) / (long long)(size ? size : 1);
+}
+
+/**
+ * @brief Mapea en memoria un archivo de snapshot y verifica su encabezado y secciones
+ *
+ * @param path Archivo de snapshot
+ * @param header Encabezado leído (en la versión 1 los campos nuevos quedan en 0)
+ * @return char* Contenido del snapshot
+ *
+ * @note Termina el programa si el archivo no existe o está dañado
+ */
+static char *map_snapshot(const char *path, SnapshotHeader *header){
+    int fd = open(path, O_RDONLY);
+    struct stat st = {0};
+    if (fd == -1 || fstat(fd, &st) == -1) {
+        printf("ERROR: No se pudo abrir el archivo '%s'\n", path);
+        exit(EXIT_FAILURE);
+    }
+    long long fileSize = st.st_size;
+    if (fileSize < (long long)SNAPSHOT_V1_HEADER_SIZE) {
+        printf("ERROR: El archivo '%s' está incompleto\n", path);
+        exit(EXIT_FAILURE);
+    }
+    char *buffer = (char *)mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (buffer == MAP_FAILED) {
+        printf("ERROR: No se pudo mapear el archivo '%s'\n", path);
+        exit(EXIT_FAILURE);
+    }
+    snapshotMapping = buffer;
+    snapshotMappingSize = fileSize;
+
+    memset(header, 0, sizeof(*header));
+    memcpy(header, buffer, SNAPSHOT_V1_HEADER_SIZE);
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || header->version < 1 || header->version > SNAPSHOT_VERSION) {
+        printf("ERROR: El archivo '%s' no es un snapshot de DevGraph compatible\n", path);
+        exit(EXIT_FAILURE);
+    }
+    if (header->version >= 2) {
+        if (fileSize < (long long)sizeof(*header)) {
+            printf("ERROR: El archivo '%s' está incompleto\n", path);
+            exit(EXIT_FAILURE);
+        }
+        memcpy(header, buffer, sizeof(*header));
+    }
+    walGeneration = header->walGeneration;
+    if (header->numUsers < 0 || header->numNodes < 0 || header->numWords < 0 ||
+        !valid_snapshot_section(header->stringsOffset, header->stringsSize, 1, fileSize) ||
+        (header->stringsSize > 0 && buffer[header->stringsOffset + header->stringsSize - 1] != '\0') ||
+        !valid_snapshot_section(header->usersOffset, header->numUsers, sizeof(SnapshotUser), fileSize) ||
+        !valid_snapshot_section(header->interestsOffset, (long long)header->numUsers * header->numWords, sizeof(InterestWord), fileSize) ||
+        !valid_snapshot_section(header->edgeOffsetsOffset, (long long)header->numNodes + 1, sizeof(int), fileSize) ||
+        !valid_snapshot_section(header->edgeTargetsOffset, header->numEdges, sizeof(int), fileSize) ||
+        !valid_snapshot_section(header->edgeWeightsOffset, header->numEdges, sizeof(double), fileSize) ||
+        !valid_snapshot_section(header->postsOffset, header->numPosts, sizeof(SnapshotPost), fileSize) ||
+        (header->version >= 2 &&
+         (!valid_snapshot_section(header->usersByIdOffset, header->numNodes, sizeof(int), fileSize) ||
+          header->usernameIndexSize < 1 || (header->usernameIndexSize & (header->usernameIndexSize - 1)) != 0 ||
+          !valid_snapshot_section(header->usernameIndexOffset, header->usernameIndexSize, sizeof(int), fileSize) ||
+          !valid_snapshot_section(header->followerOffsetsOffset, (long long)header->numNodes + 1, sizeof(int), fileSize) ||
+          !valid_snapshot_section(header->followerSourcesOffset, header->numEdges, sizeof(int), fileSize) ||
+          !valid_snapshot_section(header->followerWeightsOffset, header->numEdges, sizeof(double), fileSize)))) {
+        printf("ERROR: El archivo '%s' está dañado\n", path);
+        exit(EXIT_FAILURE);
+    }
+    return buffer;
+}
+
+/**
+ * @brief Crea un usuario con sus posts desde su registro en el snapshot, sin sus conexiones
+ *
+ * @param buffer Contenido del snapshot
+ * @param header Encabezado del snapshot
+ * @param index Posición del registro
+ * @param table Tabla hash de usuarios
+ * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ * @return User Usuario creado
+ *
+ * @note Los strings y el conjunto de intereses apuntan al mapeo. Termina el programa si el registro está dañado
+ */
+static User create_snapshot_user(char *buffer, const SnapshotHeader *header, int index, PtrToHashTable table, Graph graph, GlobalInterests globalInterests){
+    const SnapshotUser *record = (const SnapshotUser *)(buffer + header->usersOffset) + index;
+    InterestWord *interests = (InterestWord *)(buffer + header->interestsOffset);
+    const SnapshotPost *posts = (const SnapshotPost *)(buffer + header->postsOffset);
+    char *username = snapshot_string(buffer, header, record->username);
+    char *password = snapshot_string(buffer, header, record->password);
+    char *name = snapshot_string(buffer, header, record->name);
+    if (!username || !password || !name || record->numPosts < 0 || record->firstPost < 0 || record->firstPost + record->numPosts > header->numPosts) {
+        printf("ERROR: El archivo de snapshot está dañado\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* si cambió la cantidad de intereses globales no se puede usar el conjunto guardado tal cual */
+    InterestTable userInterests = &interests[(size_t)index * header->numWords];
+    if (header->numWords != globalInterests.numWords) {
+        int words = header->numWords < globalInterests.numWords ? header->numWords : globalInterests.numWords;
+        userInterests = init_user_interests(globalInterests);
+        memcpy(userInterests, &interests[(size_t)index * header->numWords], words * sizeof(InterestWord));
+    }
+
+    User newUser = create_user_from_data(username, password, name, userInterests, table, graph);
+    if (!newUser) {
+        printf("ERROR: No se pudo crear el usuario %s\n", username);
+        exit(EXIT_FAILURE);
+    }
+    assign_user_id(graph, newUser, record->id);
+    newUser->popularity = record->popularity;
+    newUser->friendliness = record->friendliness;
+    newUser->category = snapshot_string(buffer, header, record->category);
+    index_user_interests(graph, newUser, globalInterests);
+
+    /* los posts se enlazan al final para mantener el orden guardado */
+    PtrToPostNode last = newUser->posts;
+    for (long long p = record->firstPost; p < record->firstPost + record->numPosts; p++) {
+        PtrToPostNode post = (PtrToPostNode)pool_alloc(POOL_POSTS);
+        post->id = posts[p].id;
+        memset(&post->date, 0, sizeof(post->date));
+        post->date.tm_year = posts[p].year;
+        post->date.tm_mon = posts[p].month;
+        post->date.tm_mday = posts[p].day;
+        post->date.tm_hour = posts[p].hour;
+        post->date.tm_min = posts[p].minute;
+        post->date.tm_sec = posts[p].second;
+        post->date.tm_wday = posts[p].weekDay;
+        post->date.tm_yday = posts[p].yearDay;
+        post->date.tm_isdst = posts[p].isDst;
+        post->post = snapshot_string(buffer, header, posts[p].content);
+        post->priority = 0;
+        post->next = NULL;
+        last->next = post;
+        last = post;
+        newUser->posts->id++;
+    }
+    return newUser;
+}
+
+/**
+ * @brief Carga la base de datos completa desde un archivo de snapshot
+ *
+ * @param table Tabla hash de usuarios
+ * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ * @param path Archivo de snapshot
+ *
+ * @note El archivo se mapea en memoria (privado, copia al escribir) y los strings y conjuntos de intereses de los usuarios
+ *       apuntan directo al mapeo, así solo se leen las páginas que se usan. Los cambios quedan en memoria del proceso y
+ *       no llegan al archivo hasta el próximo @see write_snapshot. El mapeo se libera con @see close_database
+ */
+void load_snapshot(PtrToHashTable table, Graph graph, GlobalInterests globalInterests, const char *path){
+    SnapshotHeader header;
+    char *buffer = map_snapshot(path, &header);
+    const SnapshotUser *users = (const SnapshotUser *)(buffer + header.usersOffset);
+    const int *edgeOffsets = (const int *)(buffer + header.edgeOffsetsOffset);
+    const int *edgeTargets = (const int *)(buffer + header.edgeTargetsOffset);
+    const double *edgeWeights = (const double *)(buffer + header.edgeWeightsOffset);
+
+    /* usuario de cada id guardado (el id en memoria puede cambiar si estaba repetido) */
+    User *byStoredId = (User *)calloc((size_t)header.numNodes + 1, sizeof(User));
+    if (!byStoredId) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* usuarios en orden inverso para que la lista del grafo quede en el mismo orden que al guardar */
+    for (int i = header.numUsers - 1; i >= 0; i--) {
+        User newUser = create_snapshot_user(buffer, &header, i, table, graph, globalInterests);
+        if (users[i].id >= 0 && users[i].id < header.numNodes) byStoredId[users[i].id] = newUser;
+    }
+
+    /* aristas en el mismo orden del snapshot, add_edge las añade al final */
+    for (int id = 0; id < header.numNodes; id++) {
+        User user = byStoredId[id];
+        if (!user) continue;
+        int start = edgeOffsets[id], end = edgeOffsets[id + 1];
+        if (start < 0 || end < start || end > header.numEdges) {
+            printf("ERROR: El archivo '%s' está dañado\n", path);
+            exit(EXIT_FAILURE);
+        }
+        for (int e = start; e < end; e++) {
+            int target = edgeTargets[e];
+            if (target < 0 || target >= header.numNodes || !byStoredId[target] || byStoredId[target] == user) continue;
+            add_edge_with_weight(user, byStoredId[target], edgeWeights[e]);
+        }
+    }
+
+    free(byStoredId);
+    /* los ids de usuarios borrados antes de guardar tampoco se reutilizan */
+    reserve_graph_ids(graph, header.numNodes);
+}
+
+/**
+ * @struct _lazyDatabase
+ * @brief Estado de la carga parcial del snapshot, @see open_database
+ */
+struct _lazyDatabase{
+    SnapshotHeader header; /*!< Encabezado del snapshot */
+    User *users; /*!< Usuario creado de cada registro (NULL si no se ha cargado) */
+    unsigned char *state; /*!< Estado de cada registro (LAZY_USER_*) */
+    PtrToHashTable table; /*!< Tabla hash de usuarios */
+    Graph graph; /*!< Grafo de usuarios */
+    GlobalInterests globalInterests; /*!< Tabla de intereses globales */
+};
+
+/**
+ * @brief Obtiene el usuario de un registro del snapshot, cargándolo si hace falta
+ *
+ * @param index Posición del registro
+ * @param withConnections 1 para cargar también sus seguidos y seguidores
+ * @return User Usuario o NULL si fue borrado
+ *
+ * @note Los vecinos se cargan sin sus conexiones. Una arista con un vecino que ya tiene sus conexiones cargadas no se
+ *       agrega, porque se creó al cargar a ese vecino
+ */
+static User lazy_user(int index, int withConnections){
+    struct _lazyDatabase *lazy = lazyDatabase;
+    if (index < 0 || index >= lazy->header.numUsers || lazy->state[index] == LAZY_USER_DELETED) return NULL;
+    if (!lazy->users[index]) {
+        lazy->users[index] = create_snapshot_user(snapshotMapping, &lazy->header, index, lazy->table, lazy->graph, lazy->globalInterests);
+        lazy->state[index] = LAZY_USER_PARTIAL;
+    }
+    User user = lazy->users[index];
+    if (!withConnections || lazy->state[index] == LAZY_USER_LOADED) return user;
+    lazy->state[index] = LAZY_USER_LOADED;
+
+    int id = ((const SnapshotUser *)(snapshotMapping + lazy->header.usersOffset))[index].id;
+    const int *usersById = (const int *)(snapshotMapping + lazy->header.usersByIdOffset);
+    for (int direction = 0; direction < 2; direction++) {
+        const int *offsets = (const int *)(snapshotMapping + (direction ? lazy->header.followerOffsetsOffset : lazy->header.edgeOffsetsOffset));
+        const int *targets = (const int *)(snapshotMapping + (direction ? lazy->header.followerSourcesOffset : lazy->header.edgeTargetsOffset));
+        const double *weights = (const double *)(snapshotMapping + (direction ? lazy->header.followerWeightsOffset : lazy->header.edgeWeightsOffset));
+        if (id < 0 || id >= lazy->header.numNodes) break;
+        int start = offsets[id], end = offsets[id + 1];
+        if (start < 0 || end < start || end > lazy->header.numEdges) {
+            printf("ERROR: El archivo '%s' está dañado\n", DATABASE_SNAPSHOT_FILE);
+            exit(EXIT_FAILURE);
+        }
+        for (int e = start; e < end; e++) {
+            int target = targets[e];
+            if (target < 0 || target >= lazy->header.numNodes) continue;
+            int neighbourIndex = usersById[target];
+            if (neighbourIndex < 0 || neighbourIndex >= lazy->header.numUsers || neighbourIndex == index ||
+                lazy->state[neighbourIndex] == LAZY_USER_LOADED) continue;
+            User neighbour = lazy_user(neighbourIndex, 0);
+            if (!neighbour) continue;
+            if (direction == 0) add_edge_with_weight(user, neighbour, weights[e]);
+            else add_edge_with_weight(neighbour, user, weights[e]);
+        }
+    }
+    return user;
+}
+
+/**
+ * @brief Obtiene un usuario por su id, cargándolo con sus conexiones si la base de datos se abrió de forma parcial
+ *
+ * @param graph Grafo de usuarios
+ * @param id Id del usuario
+ * @return User Usuario o NULL si no existe
+ */
+static User user_by_id_on_demand(Graph graph, int id){
+    User user = get_user_by_id(graph, id);
+    if (!lazyDatabase) return user;
+    if (id < 0 || id >= lazyDatabase->header.numNodes) return user;
+    int index = ((const int *)(snapshotMapping + lazyDatabase->header.usersByIdOffset))[id];
+    if (index < 0 || index >= lazyDatabase->header.numUsers) return user;
+    if (user && user != lazyDatabase->users[index]) return user;
+    return lazy_user(index, 1);
+}
+
+/**
+ * @brief Completa la búsqueda de un usuario por nombre cuando la base de datos se abrió de forma parcial
+ *
+ * @param username Nombre de usuario
+ * @param user Usuario encontrado en la tabla hash (puede ser NULL)
+ * @return User Usuario con sus conexiones cargadas o NULL si no existe
+ *
+ * @note Busca en el índice de nombres del snapshot los usuarios que aún no se han cargado. Si la base de datos se cargó
+ *       completa devuelve el mismo usuario
+ */
+User load_user_on_demand(const char *username, User user){
+    struct _lazyDatabase *lazy = lazyDatabase;
+    if (!lazy || !username) return user;
+    if (user) return user_by_id_on_demand(lazy->graph, user->id);
+
+    const int *usernameIndex = (const int *)(snapshotMapping + lazy->header.usernameIndexOffset);
+    const SnapshotUser *users = (const SnapshotUser *)(snapshotMapping + lazy->header.usersOffset);
+    long long mask = lazy->header.usernameIndexSize - 1;
+    long long slot = jenkins_hash(username) & mask;
+    for (long long probes = 0; probes <= mask && usernameIndex[slot] != -1; probes++, slot = (slot + 1) & mask) {
+        int index = usernameIndex[slot];
+        if (index < 0 || index >= lazy->header.numUsers) continue;
+        const char *stored = snapshot_string(snapshotMapping, &lazy->header, users[index].username);
+        if (!stored || strcmp(stored, username) != 0) continue;
+        /* ya cargado con otro nombre de usuario (renombrado en el WAL) o borrado */
+        if (lazy->users[index] || lazy->state[index] == LAZY_USER_DELETED) return NULL;
+        return lazy_user(index, 1);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Abre la base de datos sin cargar los usuarios, que se cargan al buscarlos (carga parcial)
+ *
+ * @param table Tabla hash de usuarios
+ * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ *
+ * @note Solo con un snapshot de versión 2 o mayor; si no, se carga la base de datos completa con @see load_database.
+ *       Los usuarios nombrados en el WAL se cargan al aplicarlo. Con la carga parcial el WAL no se incorpora al snapshot
+ */
+void open_database(PtrToHashTable table, Graph graph, GlobalInterests globalInterests){
+    SnapshotHeader header;
+    struct stat st = {0};
+    if (stat(DATABASE_SNAPSHOT_FILE, &st) != 0) {
+        load_database(table, graph, globalInterests);
+        return;
+    }
+    char *buffer = map_snapshot(DATABASE_SNAPSHOT_FILE, &header);
+    if (header.version < 2) {
+        munmap(buffer, snapshotMappingSize);
+        snapshotMapping = NULL;
+        snapshotMappingSize = 0;
+        load_database(table, graph, globalInterests);
+        return;
+    }
+
+    lazyDatabase = (struct _lazyDatabase *)malloc(sizeof(struct _lazyDatabase));
+    if (!lazyDatabase) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    lazyDatabase->header = header;
+    lazyDatabase->users = (User *)calloc((size_t)header.numUsers + 1, sizeof(User));
+    lazyDatabase->state = (unsigned char *)calloc((size_t)header.numUsers + 1, sizeof(unsigned char));
+    if (!lazyDatabase->users || !lazyDatabase->state) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    lazyDatabase->table = table;
+    lazyDatabase->graph = graph;
+    lazyDatabase->globalInterests = globalInterests;
+
+    /* los ids guardados quedan reservados para que los usuarios nuevos no los usen */
+    reserve_graph_ids(graph, header.numNodes);
+    snapshotMode = 1;
+    replay_wal(table, graph, globalInterests);
+    for (User user = graph->graphUsersList->next; user; user = user->next) {
+        user->dirty = 0;
+        user->savedPosts = user->posts->id;
+    }
+}
+
+/**
+ * @brief Libera memoria de un usuario o post, salvo que esté dentro del snapshot mapeado
+ *
+ * @param pointer Memoria a liberar (puede ser NULL)
+ *
+ * @note Los strings de la arena se liberan con @see arena_release, que busca su bloque en O(log bloques)
+ */
+void free_database_memory(void *pointer){
+    const char *address = (const char *)pointer;
+    if (snapshotMapping && address >= snapshotMapping && address < snapshotMapping + snapshotMappingSize) return;
+    if (arena_release(pointer)) return;
+    free(pointer);
+}
+
+/**
+ * @brief Libera el snapshot mapeado en memoria
+ *
+ * @note Ejecutar despues de @see free_all_users, ya que los usuarios pueden apuntar al mapeo
+ */
+void close_database(void){
+    if (lazyDatabase) {
+        free(lazyDatabase->users);
+        free(lazyDatabase->state);
+        free(lazyDatabase);
+        lazyDatabase = NULL;
+    }
+    if (!snapshotMapping) return;
+    munmap(snapshotMapping, snapshotMappingSize);
+    snapshotMapping = NULL;
+    snapshotMappingSize = 0;
+}
+
+/**
+ * @brief Migra la base de datos desde las carpetas de cada usuario a un único archivo de snapshot
+ *
+ * @param graph Grafo de usuarios (cargado desde las carpetas)
+ * @param globalInterests Tabla de intereses globales
+ *
+ * @note Las carpetas de los usuarios se borran solo si el snapshot se escribió correctamente
+ */
+void migrate_database(Graph graph, GlobalInterests globalInterests){
+    if (snapshotMode) {
+        printf("La base de datos ya está guardada en '%s'.\n", DATABASE_SNAPSHOT_FILE);
+        return;
+    }
+    create_database_dir();
+    remove(WAL_FILE);
+    walGeneration = 0;
+    if (write_snapshot(graph, globalInterests, DATABASE_SNAPSHOT_FILE) != 0) return;
+    for (User user = graph->graphUsersList->next; user; user = user->next) {
+        remove_user_directory(user->username);
+    }
+    snapshotMode = 1;
+
+    struct stat st = {0};
+    stat(DATABASE_SNAPSHOT_FILE, &st);
+    printf("Se migraron %d usuarios a '%s' (%lld bytes).\n", graph->usersNumber, DATABASE_SNAPSHOT_FILE, (long long)st.st_size);
+}
+
+/* WAL */
+
+/**
+ * @brief Hash FNV-1a de un bloque de bytes, usado como checksum de los registros del WAL
+ *
+ * @param data Datos
+ * @param length Cantidad de bytes
+ * @return unsigned int
+ */
+static unsigned int wal_checksum(const char *data, int length){
+    unsigned int hash = 2166136261U;
+    for (int i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+/**
+ * @brief Agrega un registro al WAL
+ *
+ * @param type Tipo de registro (WAL_FOLLOW, WAL_POST, ...)
+ * @param user Usuario que hace el cambio
+ * @param data Datos del registro
+ * @param length Cantidad de bytes de datos
+ *
+ * @note Solo con el snapshot. El registro queda en memoria y se escribe junto con los demás en @see write_wal (group commit)
+ */
+void append_wal_record(int type, User user, const void *data, int length){
+    if (!snapshotMode) return;
+    WalRecord record;
+    record.type = type;
+    record.userId = user->id;
+    record.length = length;
+    record.checksum = wal_checksum((const char *)data, length);
+
+    size_t needed = walBufferSize + sizeof(record) + length;
+    if (needed > walBufferCapacity) {
+        size_t capacity = walBufferCapacity ? walBufferCapacity * 2 : 4096;
+        while (capacity < needed) capacity *= 2;
+        char *buffer = (char *)realloc(walBuffer, capacity);
+        if (!buffer) {
+            printf("ERROR: No hay memoria suficiente\n");
+            exit(EXIT_FAILURE);
+        }
+        walBuffer = buffer;
+        walBufferCapacity = capacity;
+    }
+    memcpy(walBuffer + walBufferSize, &record, sizeof(record));
+    if (length > 0) memcpy(walBuffer + walBufferSize + sizeof(record), data, length);
+    walBufferSize = needed;
+
+    if (walBufferSize >= WAL_GROUP_COMMIT_SIZE) write_wal();
+}
+
+/**
+ * @brief Agrega al WAL un post recién creado
+ *
+ * @param user Autor del post
+ * @param post Post
+ */
+void append_wal_post(User user, PtrToPostNode post){
+    if (!snapshotMode) return;
+    const char *content = post->post ? post->post : "";
+    int length = sizeof(SnapshotPost) + strlen(content) + 1;
+    char *data = (char *)calloc(length, 1);
+    if (!data) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    SnapshotPost *record = (SnapshotPost *)data;
+    record->id = post->id;
+    record->year = post->date.tm_year;
+    record->month = post->date.tm_mon;
+    record->day = post->date.tm_mday;
+    record->hour = post->date.tm_hour;
+    record->minute = post->date.tm_min;
+    record->second = post->date.tm_sec;
+    record->weekDay = post->date.tm_wday;
+    record->yearDay = post->date.tm_yday;
+    record->isDst = post->date.tm_isdst;
+    record->content = -1;
+    strcpy(data + sizeof(SnapshotPost), content);
+    append_wal_record(WAL_POST, user, data, length);
+    free(data);
+}
+
+/**
+ * @brief Agrega al WAL un usuario recién registrado con sus intereses
+ *
+ * @param user Usuario
+ * @param globalInterests Tabla de intereses globales
+ */
+void append_wal_register(User user, GlobalInterests globalInterests){
+    if (!snapshotMode) return;
+    size_t username = strlen(user->username) + 1, password = strlen(user->password) + 1, name = strlen(user->name) + 1;
+    size_t interests = globalInterests.numWords * sizeof(InterestWord);
+    int length = username + password + name + interests;
+    char *data = (char *)malloc(length);
+    if (!data) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(data, user->username, username);
+    memcpy(data + username, user->password, password);
+    memcpy(data + username + password, user->name, name);
+    memcpy(data + username + password + name, user->interests, interests);
+    append_wal_record(WAL_REGISTER, user, data, length);
+    free(data);
+}
+
+/**
+ * @brief Escribe al WAL los registros acumulados en memoria con una sola escritura y sincronización (group commit)
+ *
+ * @return int 0 si se escribe correctamente, -1 si hay un error
+ */
+int write_wal(void){
+    if (walBufferSize == 0) return 0;
+    FILE *fp = fopen(WAL_FILE, "ab");
+    if (!fp) {
+        printf("ERROR: No se pudo guardar el archivo '%s'\n", WAL_FILE);
+        return -1;
+    }
+    int error = 0;
+    if (ftell(fp) == 0) {
+        WalHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, WAL_MAGIC, sizeof(WAL_MAGIC));
+        header.generation = walGeneration;
+        error |= fwrite(&header, sizeof(header), 1, fp) != 1;
+    }
+    error |= fwrite(walBuffer, 1, walBufferSize, fp) != walBufferSize;
+    error |= fflush(fp) != 0 || fsync(fileno(fp)) != 0;
+    error |= fclose(fp) != 0;
+    if (error) {
+        printf("ERROR: No se pudo guardar el archivo '%s'\n", WAL_FILE);
+        return -1;
+    }
+    walBufferSize = 0;
+    return 0;
+}
+
+/**
+ * @brief Obtiene el siguiente string de los datos de un registro del WAL
+ *
+ * @param cursor Posición actual (se avanza después del string)
+ * @param end Fin de los datos
+ * @return const char* String o NULL si no termina antes del fin
+ */
+static const char *next_wal_string(const char **cursor, const char *end){
+    const char *string = *cursor;
+    const char *terminator = memchr(string, '\0', end - string);
+    if (!terminator) return NULL;
+    *cursor = terminator + 1;
+    return string;
+}
+
+/**
+ * @brief Aplica un registro del WAL a las estructuras en memoria
+ *
+ * @param record Encabezado del registro
+ * @param data Datos del registro
+ * @param table Tabla hash de usuarios
+ * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ */
+static void apply_wal_record(const WalRecord *record, const char *data, PtrToHashTable table, Graph graph, GlobalInterests globalInterests){
+    const char *cursor = data, *end = data + record->length;
+    User user = user_by_id_on_demand(graph, record->userId);
+    if (!user && record->type != WAL_REGISTER) return;
+
+    switch (record->type) {
+    case WAL_FOLLOW:
+    case WAL_UNFOLLOW: {
+        int targetId;
+        if (record->length != sizeof(int)) return;
+        memcpy(&targetId, data, sizeof(int));
+        User target = user_by_id_on_demand(graph, targetId);
+        if (!target || target == user) return;
+        if (record->type == WAL_FOLLOW) add_edge(user, target, globalInterests);
+        else remove_edge(user, target);
+        break;
+    }
+    case WAL_POST: {
+        SnapshotPost postRecord;
+        if (record->length < (int)sizeof(SnapshotPost) + 1 || end[-1] != '\0') return;
+        memcpy(&postRecord, data, sizeof(SnapshotPost));
+        PtrToPostNode post = insert_post(user->posts, (char *)(data + sizeof(SnapshotPost)));
+        post->id = postRecord.id;
+        memset(&post->date, 0, sizeof(post->date));
+        post->date.tm_year = postRecord.year;
+        post->date.tm_mon = postRecord.month;
+        post->date.tm_mday = postRecord.day;
+        post->date.tm_hour = postRecord.hour;
+        post->date.tm_min = postRecord.minute;
+        post->date.tm_sec = postRecord.second;
+        post->date.tm_wday = postRecord.weekDay;
+        post->date.tm_yday = postRecord.yearDay;
+        post->date.tm_isdst = postRecord.isDst;
+        break;
+    }
+    case WAL_EDIT_NAME:
+    case WAL_EDIT_PASSWORD: {
+        const char *value = next_wal_string(&cursor, end);
+        if (!value) return;
+        char **field = record->type == WAL_EDIT_NAME ? &user->name : &user->password;
+        free_database_memory(*field);
+        *field = copy_edited_string(value);
+        break;
+    }
+    case WAL_EDIT_USERNAME: {
+        const char *value = next_wal_string(&cursor, end);
+        if (!value || search_user((char *)value, table)) return;
+        delete_from_hash_table(table, user->username);
+        free_database_memory(user->username);
+        user->username = copy_edited_string(value);
+        insert_into_hash_table(table, user->username, user);
+        break;
+    }
+    case WAL_REGISTER: {
+        const char *username = next_wal_string(&cursor, end);
+        const char *password = username ? next_wal_string(&cursor, end) : NULL;
+        const char *name = password ? next_wal_string(&cursor, end) : NULL;
+        if (!name || user) return;
+        User newUser = create_new_user(username, password, name, table, graph, globalInterests);
+        if (!newUser) return;
+        assign_user_id(graph, newUser, record->userId);
+        size_t interests = (size_t)(end - cursor);
+        if (interests > globalInterests.numWords * sizeof(InterestWord)) interests = globalInterests.numWords * sizeof(InterestWord);
+        memcpy(newUser->interests, cursor, interests);
+        index_user_interests(graph, newUser, globalInterests);
+        break;
+    }
+    case WAL_DELETE:
+        if (lazyDatabase && user->id < lazyDatabase->header.numNodes) {
+            int index = ((const int *)(snapshotMapping + lazyDatabase->header.usersByIdOffset))[user->id];
+            if (index >= 0 && index < lazyDatabase->header.numUsers && lazyDatabase->users[index] == user) {
+                lazyDatabase->users[index] = NULL;
+                lazyDatabase->state[index] = LAZY_USER_DELETED;
+            }
+        }
+        delete_user(user, table, graph);
+        break;
+    }
+}
+
+/**
+ * @brief Aplica los cambios del WAL sobre la base de datos cargada desde el snapshot
+ *
+ * @param table Tabla hash de usuarios
+ * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ *
+ * @note Si el WAL es de otra generación ya está incorporado al snapshot y se borra. Si el último registro quedó escrito a medias
+ *       (checksum distinto o incompleto) se corta el archivo en el último registro válido
+ */
+void replay_wal(PtrToHashTable table, Graph graph, GlobalInterests globalInterests){
+    FILE *fp = fopen(WAL_FILE, "rb");
+    if (!fp) return;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char *buffer = (char *)malloc(size > 0 ? size : 1);
+    if (!buffer) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t readBytes = size > 0 ? fread(buffer, 1, size, fp) : 0;
+    fclose(fp);
+
+    WalHeader header;
+    if ((long)readBytes != size || size < (long)sizeof(header)) {
+        free(buffer);
+        remove(WAL_FILE);
+        return;
+    }
+    memcpy(&header, buffer, sizeof(header));
+    if (memcmp(header.magic, WAL_MAGIC, sizeof(WAL_MAGIC)) != 0 || header.generation != walGeneration) {
+        free(buffer);
+        remove(WAL_FILE);
+        return;
+    }
+
+    long position = sizeof(header);
+    while (position + (long)sizeof(WalRecord) <= size) {
+        WalRecord record;
+        memcpy(&record, buffer + position, sizeof(record));
+        const char *data = buffer + position + sizeof(record);
+        if (record.length < 0 || record.length > size - position - (long)sizeof(record) ||
+            wal_checksum(data, record.length) != record.checksum) break;
+        apply_wal_record(&record, data, table, graph, globalInterests);
+        position += sizeof(record) + record.length;
+    }
+    if (position < size && truncate(WAL_FILE, position) != 0) {
+        printf("ERROR: No se pudo reparar el archivo '%s'\n", WAL_FILE);
+    }
+    free(buffer);
+}
+
+/**
+ * @brief Incorpora los cambios del WAL al snapshot y deja el WAL vacío
+ *
+ * @param graph Grafo de usuarios (con el WAL ya aplicado)
+ * @param globalInterests Tabla de intereses globales
+ * @return int 0 si se incorpora correctamente, -1 si hay un error
+ *
+ * @note El snapshot nuevo lleva la siguiente generación, así si el programa se corta antes de borrar el WAL sus registros
+ *       no se vuelven a aplicar
+ */
+int fold_wal_into_snapshot(Graph graph, GlobalInterests globalInterests){
+    if (lazyDatabase) return -1; /* faltan los usuarios que no se cargaron */
+    walGeneration++;
+    if (write_snapshot(graph, globalInterests, DATABASE_SNAPSHOT_FILE) != 0) {
+        walGeneration--;
+        return -1;
+    }
+    walBufferSize = 0;
+    remove(WAL_FILE);
+    return 0;
+}
+
+/**
+ * @brief Incorpora el WAL al snapshot a pedido del usuario
+ *
+ * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ */
+void compact_database(Graph graph, GlobalInterests globalInterests){
+    if (!snapshotMode) {
+        printf("La base de datos no está en un snapshot. Ejecute './devgraph -i' para migrarla.\n");
+        return;
+    }
+    struct stat st = {0};
+    long long walSize = stat(WAL_FILE, &st) == 0 ? (long long)st.st_size : 0;
+    if (fold_wal_into_snapshot(graph, globalInterests) != 0) return;
+    stat(DATABASE_SNAPSHOT_FILE, &st);
+    printf("Se incorporaron %lld bytes del WAL a '%s' (%lld bytes).\n", walSize, DATABASE_SNAPSHOT_FILE, (long long)st.st_size);
+}
@@ -12,44 +12,200 @@
 
 #include "graph.h"
 
+static unsigned int edgesVersion = 1; /* aumenta con cada cambio de aristas o ids, en cualquier grafo (las aristas no conocen su grafo), @see get_csr_graph */
+
+/**
+ * @brief Inicia una adyacencia vacía
+ *
+ * @return Adjacency
+ *
+ * @note El arreglo de aristas se reserva con la primera arista
+ */
+Adjacency init_adjacency(void){
+    Adjacency adjacency = (Adjacency)pool_alloc(POOL_EDGES);
+    adjacency->edges = NULL;
+    adjacency->size = 0;
+    adjacency->capacity = 0;
+    adjacency->index = NULL;
+    adjacency->indexCapacity = 0;
+    return adjacency;
+}
+
 /**
- * @brief Inicia una lista de adyacencia vacía
+ * @brief Libera una adyacencia, sin tocar las de los usuarios destino
  *
- * @return Edge
+ * @param adjacency Adyacencia (puede ser NULL)
  */
-Edge init_empty_edge(void){
-    Edge newEdge = (Edge)malloc(sizeof(struct _edge));
-    if (!newEdge){
+void free_adjacency(Adjacency adjacency){
+    if (!adjacency) return;
+    free(adjacency->edges);
+    free(adjacency->index);
+    pool_free(POOL_EDGES, adjacency);
+}
+
+/**
+ * @brief Casilla inicial de un usuario en el índice de una adyacencia
+ *
+ * @param adjacency Adyacencia con índice
+ * @param user Usuario destino
+ * @return int Casilla
+ */
+static int adjacency_home(Adjacency adjacency, User user){
+    uint64_t hash = (uint64_t)(uintptr_t)user * 0x9E3779B97F4A7C15ULL;
+    return (int)(hash >> 32) & (adjacency->indexCapacity - 1);
+}
+
+/**
+ * @brief Busca la casilla del índice que apunta a un usuario
+ *
+ * @param adjacency Adyacencia con índice
+ * @param user Usuario destino
+ * @return int Casilla, o la casilla vacía donde debería estar si no se encuentra
+ */
+static int adjacency_slot(Adjacency adjacency, User user){
+    int mask = adjacency->indexCapacity - 1;
+    int slot = adjacency_home(adjacency, user);
+    while (adjacency->index[slot] != -1 && adjacency->edges[adjacency->index[slot]].dest != user){
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * @brief Reconstruye el índice de una adyacencia con una capacidad dada
+ *
+ * @param adjacency Adyacencia
+ * @param indexCapacity Casillas del índice, potencia de 2 mayor al doble de la cantidad de aristas
+ */
+static void rebuild_adjacency_index(Adjacency adjacency, int indexCapacity){
+    int *newIndex = (int *)malloc(indexCapacity * sizeof(int));
+    if (!newIndex){
         printf("ERROR: No hay memoria suficiente\n");
         exit(EXIT_FAILURE);
     }
-    newEdge->dest = NULL;
-    newEdge->weight = 0;
-    newEdge->next = NULL;
-    return newEdge;
+    memset(newIndex, -1, indexCapacity * sizeof(int));
+    free(adjacency->index);
+    adjacency->index = newIndex;
+    adjacency->indexCapacity = indexCapacity;
+    for (int i = 0; i < adjacency->size; i++){
+        adjacency->index[adjacency_slot(adjacency, adjacency->edges[i].dest)] = i;
+    }
 }
 
 /**
- * @brief Busca la adyacencia anterior a un usuario en una lista de adyacencia
+ * @brief Busca la posición de un usuario en una adyacencia
  *
- * @param edge Lista de adyacencia
- * @param user Usuario a buscar la adyacencia anterior
- * @return Edge Adyacencia anterior encontrada o NULL si no se encuentra
+ * @param adjacency Adyacencia
+ * @param user Usuario destino
+ * @return int Posición en el arreglo de aristas, -1 si no está
  */
-Edge search_previous_in_edge(Edge edge, User user){
-    
-    if (!edge || !user){
+static int adjacency_position(Adjacency adjacency, User user){
+    if (!adjacency->index){
+        for (int i = 0; i < adjacency->size; i++){
+            if (adjacency->edges[i].dest == user) return i;
+        }
+        return -1;
+    }
+    return adjacency->index[adjacency_slot(adjacency, user)];
+}
+
+/**
+ * @brief Busca la arista hacia un usuario en una adyacencia
+ *
+ * @param adjacency Adyacencia
+ * @param user Usuario destino
+ * @return Edge Arista encontrada o NULL si no se encuentra
+ */
+Edge search_edge(Adjacency adjacency, User user){
+    if (!adjacency || !user){
         return NULL;
     }
+    int position = adjacency_position(adjacency, user);
+    return position < 0 ? NULL : &adjacency->edges[position];
+}
+
+/**
+ * @brief Añade una arista al final de una adyacencia si el destino no estaba
+ *
+ * @param adjacency Adyacencia
+ * @param user Usuario destino
+ * @param weight Peso de la arista
+ * @return int 1 si se añadió, 0 si ya había una arista hacia el usuario
+ *
+ * @note La búsqueda que detecta el duplicado es la misma que encuentra la casilla libre del índice
+ */
+static int adjacency_insert(Adjacency adjacency, User user, double weight){
+    int slot = -1;
+    if (adjacency->index){
+        slot = adjacency_slot(adjacency, user);
+        if (adjacency->index[slot] != -1) return 0;
+    }
+    else if (adjacency_position(adjacency, user) >= 0){
+        return 0;
+    }
 
-    Edge aux = edge;
-    while (aux->next){
-        if (aux->next->dest == user){
-            return aux;
+    if (adjacency->size == adjacency->capacity){
+        int newCapacity = adjacency->capacity ? adjacency->capacity * 2 : ADJACENCY_INITIAL_CAPACITY;
+        Edge newEdges = (Edge)realloc(adjacency->edges, newCapacity * sizeof(struct _edge));
+        if (!newEdges){
+            printf("ERROR: No hay memoria suficiente\n");
+            exit(EXIT_FAILURE);
         }
-        aux = aux->next;
+        adjacency->edges = newEdges;
+        adjacency->capacity = newCapacity;
     }
-    return NULL;
+    int position = adjacency->size++;
+    adjacency->edges[position].dest = user;
+    adjacency->edges[position].weight = weight;
+
+    if (adjacency->index && adjacency->size * 2 <= adjacency->indexCapacity){
+        adjacency->index[slot] = position;
+    }
+    else if (adjacency->size > ADJACENCY_INDEX_THRESHOLD){
+        int indexCapacity = adjacency->indexCapacity ? adjacency->indexCapacity : 1;
+        while (indexCapacity < adjacency->size * 4) indexCapacity *= 2;
+        rebuild_adjacency_index(adjacency, indexCapacity);
+    }
+    return 1;
+}
+
+/**
+ * @brief Quita la arista hacia un usuario de una adyacencia
+ *
+ * @param adjacency Adyacencia
+ * @param user Usuario destino
+ * @return int 1 si se quitó, 0 si no había una arista hacia el usuario
+ *
+ * @note La última arista pasa a ocupar el lugar de la quitada. En el índice se usa borrado por desplazamiento hacia atrás
+ *       (sin marcas de borrado), así las búsquedas no se alargan con el tiempo
+ */
+static int adjacency_erase(Adjacency adjacency, User user){
+    int position;
+    if (adjacency->index){
+        int mask = adjacency->indexCapacity - 1;
+        int hole = adjacency_slot(adjacency, user);
+        position = adjacency->index[hole];
+        if (position < 0) return 0;
+        for (int slot = (hole + 1) & mask; adjacency->index[slot] != -1; slot = (slot + 1) & mask){
+            int home = adjacency_home(adjacency, adjacency->edges[adjacency->index[slot]].dest);
+            int reachable = hole <= slot ? (home > hole && home <= slot) : (home > hole || home <= slot);
+            if (reachable) continue;
+            adjacency->index[hole] = adjacency->index[slot];
+            hole = slot;
+        }
+        adjacency->index[hole] = -1;
+    }
+    else {
+        position = adjacency_position(adjacency, user);
+        if (position < 0) return 0;
+    }
+
+    int last = --adjacency->size;
+    if (position != last){
+        if (adjacency->index) adjacency->index[adjacency_slot(adjacency, adjacency->edges[last].dest)] = position;
+        adjacency->edges[position] = adjacency->edges[last];
+    }
+    return 1;
 }
 
 /**
@@ -72,6 +228,20 @@ Graph initialize_graph(void){
     newGraph->graphUsersList->next = NULL;
 
     newGraph->usersNumber = 0;
+    newGraph->idCapacity = GRAPH_INITIAL_ID_CAPACITY;
+    newGraph->nextId = 0;
+    newGraph->interestIndex = NULL;
+    newGraph->numIndexedInterests = 0;
+    newGraph->overlapCounts = NULL;
+    newGraph->overlapCapacity = 0;
+    newGraph->interestsVersion = 0;
+    newGraph->csr = NULL;
+    newGraph->csrVersion = 0;
+    newGraph->usersById = (User *)calloc(newGraph->idCapacity, sizeof(User));
+    if (!newGraph->usersById){
+        printf("Error al crear el grafo (índice de usuarios)\n");
+        exit(EXIT_FAILURE);
+    }
     return newGraph;
 }
 
@@ -83,20 +253,114 @@ Graph initialize_graph(void){
  * @note Ejecutar despues de @see free_all_users
  */
 void free_graph(Graph graph){
+    free_csr_graph(graph->csr);
+    clear_interest_index(graph);
+    free(graph->overlapCounts);
+    free(graph->usersById);
     free(graph->graphUsersList);
     free(graph);
 }
 
+/**
+ * @brief Saca a todos los usuarios del grafo de una vez, sin liberarlos
+ *
+ * @param graph Grafo
+ *
+ * @note Los ids no se reinician, igual que al sacar usuarios uno por uno (@see remove_user_from_graph)
+ */
+void clear_graph_users(Graph graph){
+    graph->graphUsersList->next = NULL;
+    memset(graph->usersById, 0, graph->idCapacity * sizeof(User));
+    graph->usersNumber = 0;
+    edgesVersion++;
+}
+
+/**
+ * @brief Asegura que el arreglo de usuarios por id tenga espacio para un id
+ *
+ * @param graph Grafo
+ * @param id Id que debe caber en el arreglo
+ */
+static void reserve_user_ids(Graph graph, int id){
+    if (id < graph->idCapacity) return;
+    int newCapacity = graph->idCapacity;
+    while (newCapacity <= id) newCapacity *= 2;
+    User *newArray = (User *)realloc(graph->usersById, newCapacity * sizeof(User));
+    if (!newArray){
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(newArray + graph->idCapacity, 0, (newCapacity - graph->idCapacity) * sizeof(User));
+    graph->usersById = newArray;
+    graph->idCapacity = newCapacity;
+}
+
+/**
+ * @brief Asigna un id denso a un usuario del grafo
+ *
+ * @param graph Grafo
+ * @param user Usuario
+ * @param id Id solicitado (por ejemplo el guardado en la base de datos), -1 para usar el siguiente libre
+ *
+ * @note Si el id solicitado está ocupado o es inválido se asigna el siguiente libre. Los ids no se reutilizan para que sean estables.
+ */
+void assign_user_id(Graph graph, User user, int id){
+    if (user->id >= 0 && user->id < graph->nextId && graph->usersById[user->id] == user){
+        if (user->id == id) return;
+        graph->usersById[user->id] = NULL;
+        // si era el último id entregado, se devuelve para no dejar huecos
+        if (user->id == graph->nextId - 1) graph->nextId--;
+    }
+
+    if (id < 0 || id >= graph->nextId + GRAPH_MAX_ID_GAP || (id < graph->nextId && graph->usersById[id])){
+        id = graph->nextId;
+    }
+    reserve_user_ids(graph, id);
+    graph->usersById[id] = user;
+    user->id = id;
+    edgesVersion++;
+    if (id >= graph->nextId) graph->nextId = id + 1;
+}
+
+/**
+ * @brief Reserva los ids [0, numNodes) para que los usuarios nuevos reciban ids mayores
+ *
+ * @param graph Grafo
+ * @param numNodes Cantidad de ids a reservar
+ *
+ * @note Se usa al abrir la base de datos sin cargar todos los usuarios, cuyos ids deben quedar libres para ellos
+ */
+void reserve_graph_ids(Graph graph, int numNodes){
+    if (numNodes <= graph->nextId) return;
+    reserve_user_ids(graph, numNodes - 1);
+    graph->nextId = numNodes;
+}
+
+/**
+ * @brief Obtiene un usuario según su id
+ *
+ * @param graph Grafo
+ * @param id Id del usuario
+ * @return User Usuario o NULL si el id no está en uso
+ */
+User get_user_by_id(Graph graph, int id){
+    if (id < 0 || id >= graph->nextId) return NULL;
+    return graph->usersById[id];
+}
+
 /**
  * @brief Añade un usuario (ya creado) al grafo
  *
  * @param graph Grafo
  * @param user Usuario a añadir
+ *
+ * @note Si el usuario no tiene id se le asigna el siguiente libre
  */
 void add_user_to_graph(Graph graph, User user){
     user->next = graph->graphUsersList->next;
     graph->graphUsersList->next = user;
     graph->usersNumber++;
+    assign_user_id(graph, user, user->id);
 }
 
 /**
@@ -114,6 +378,8 @@ void remove_user_from_graph(Graph graph, User user){
     }
     aux->next = user->next;
     user->next = NULL;
+    if (get_user_by_id(graph, user->id) == user) graph->usersById[user->id] = NULL;
+    unindex_user_interests(graph, user);
     free_all_edges(user);
     graph->usersNumber--;
 }
@@ -124,39 +390,45 @@ void remove_user_from_graph(Graph graph, User user){
  * @param user1 Usuario 1 que añade a Usuario 2
  * @param user2 Usuario 2 será añadido por usuario 1
  * @param globalInterests Tabla de intereses globales
+ * @return int 1 si se añadió, 0 si usuario 1 ya seguía a usuario 2 o ambos son el mismo usuario
  * 
  * @note El peso de la conexión será el índice de distancia de jaccard entre ambos usuarios
  */
-void add_edge(User user1, User user2, GlobalInterests globalInterests){
-
-    if (user1 == user2){
-        printf("Un usuario no puede ser amigo de si mismo\n");
-        exit(EXIT_FAILURE);
-    }
-    
-    double weight=edge_jaccard(user1, user2, globalInterests);
-    
-    Edge newEdgeUser1 = (Edge)malloc(sizeof(struct _edge));
-    newEdgeUser1->dest = user2;
-    newEdgeUser1->weight = weight;
-
-    Edge newEdgeUser2 = (Edge)malloc(sizeof(struct _edge));
-    newEdgeUser2->dest = user1;
-    newEdgeUser2->weight = weight;
+int add_edge(User user1, User user2, GlobalInterests globalInterests){
+    if (search_edge(user1->following, user2)) return 0;
+    return add_edge_with_weight(user1, user2, edge_jaccard(user1, user2, globalInterests));
+}
 
-    if (!newEdgeUser1 || !newEdgeUser2){
-        printf("Error al crear enlace entre usuarios\n");
-        return;
-    }
+/**
+ * @brief Añade una adyacencia entre dos usuarios con un peso ya conocido
+ *
+ * @param user1 Usuario 1 que añade a Usuario 2
+ * @param user2 Usuario 2 será añadido por usuario 1
+ * @param weight Peso de la conexión
+ * @return int 1 si se añadió, 0 si usuario 1 ya seguía a usuario 2 o ambos son el mismo usuario
+ *
+ * @note Se usa al cargar conexiones con su peso guardado, sin recalcular la distancia de jaccard. Una conexión de un usuario
+ *       consigo mismo (por ejemplo, en un archivo dañado) se ignora
+ */
+int add_edge_with_weight(User user1, User user2, double weight){
 
+    /* un usuario no puede seguirse a sí mismo */
+    if (user1 == user2) return 0;
+    
     /* unir conexiones*/
-    newEdgeUser1->next = user1->following->next;
-    user1->following->next = newEdgeUser1;
+    if (!adjacency_insert(user1->following, user2, weight)){
+        return 0;
+    }
     user1->numFollowing++;
 
-    newEdgeUser2->next = user2->followers->next;
-    user2->followers->next = newEdgeUser2;
+    adjacency_insert(user2->followers, user1, weight);
     user2->numFollowers++;
+    edgesVersion++;
+
+    /* la amigabilidad guardada depende de la cantidad de seguidos y seguidores */
+    user1->dirty |= USER_DIRTY_FOLLOWING | USER_DIRTY_PROFILE;
+    user2->dirty |= USER_DIRTY_FOLLOWERS | USER_DIRTY_PROFILE;
+    return 1;
 }
 
 /**
@@ -164,37 +436,30 @@ void add_edge(User user1, User user2, GlobalInterests globalInterests){
  *
  * @param user1 Usuario 1 que deja de seguir a Usuario 2
  * @param user2 Usuario 2 le deja de seguir Usuario 1
+ * @return int 1 si se quitó, 0 si usuario 1 no seguía a usuario 2
  *
  * @note Para usuario 1 elimina a usuario 1 de su lista de seguidos, y para usuario 2 se elimina usuario de su lista de seguidores
  */
-void remove_edge(User user1, User user2){
+int remove_edge(User user1, User user2){
 
     if (!user1 || !user2) {
-        return;
+        return 0;
     }
     if (!user1->following || !user2->followers) {
-        return;
-    }
-    Edge aux1 = search_previous_in_edge(user1->following, user2);
-    Edge aux2 = search_previous_in_edge(user2->followers, user1);
-    if (!aux1 || !aux2){
-        
-        return;
+        return 0;
     }
-    Edge toRemove1 = aux1->next;
-    Edge toRemove2 = aux2->next;
-    
-    if (toRemove1){
-        aux1->next = toRemove1->next;
-        free(toRemove1);
-        user1->numFollowing--;
+    if (!adjacency_erase(user1->following, user2)){
+        return 0;
     }
+    user1->numFollowing--;
 
-    if (toRemove2){
-        aux2->next = toRemove2->next;
-        free(toRemove2);
+    if (adjacency_erase(user2->followers, user1)){
         user2->numFollowers--;
     }
+    edgesVersion++;
+    user1->dirty |= USER_DIRTY_FOLLOWING | USER_DIRTY_PROFILE;
+    user2->dirty |= USER_DIRTY_FOLLOWERS | USER_DIRTY_PROFILE;
+    return 1;
 }
 
 /**
@@ -202,26 +467,306 @@ void remove_edge(User user1, User user2){
  *
  * @param user Usuario
  *
- * @note Libera también las adyacencias de los usuarios que lo siguen o sigue
+ * @note Libera también las adyacencias de los usuarios que lo siguen o sigue. Cada una se quita en O(1), así el costo es
+ *       lineal en la cantidad de conexiones del usuario
  */
 void free_all_edges(User user){
-    // Liberar todas las conexiones de la lista de seguidos
-    Edge current = user->following->next;
-    while (current){
-        Edge next = current->next;
-        remove_edge(user, current->dest);
-        current = next;
+    // Quitar al usuario de los seguidores de cada seguido
+    Adjacency following = user->following;
+    for (int i = 0; i < following->size; i++){
+        User dest = following->edges[i].dest;
+        if (adjacency_erase(dest->followers, user)) dest->numFollowers--;
+        dest->dirty |= USER_DIRTY_FOLLOWERS | USER_DIRTY_PROFILE;
     }
+    if (following->size) user->dirty |= USER_DIRTY_FOLLOWING | USER_DIRTY_PROFILE;
+    following->size = 0;
+    if (following->index) memset(following->index, -1, following->indexCapacity * sizeof(int));
     user->numFollowing = 0;
 
-    // Liberar todas las conexiones de la lista de seguidores
-    current = user->followers->next;
-    while (current){
-        Edge next = current->next;
-        remove_edge(current->dest, user);
-        current = next;
+    // Quitar al usuario de los seguidos de cada seguidor
+    Adjacency followers = user->followers;
+    for (int i = 0; i < followers->size; i++){
+        User source = followers->edges[i].dest;
+        if (adjacency_erase(source->following, user)) source->numFollowing--;
+        source->dirty |= USER_DIRTY_FOLLOWING | USER_DIRTY_PROFILE;
     }
+    if (followers->size) user->dirty |= USER_DIRTY_FOLLOWERS | USER_DIRTY_PROFILE;
+    followers->size = 0;
+    if (followers->index) memset(followers->index, -1, followers->indexCapacity * sizeof(int));
     user->numFollowers = 0;
+    edgesVersion++;
+}
+
+/**
+ * @brief Busca la posición de un id en una lista ordenada del índice de intereses
+ *
+ * @param postings Lista del índice
+ * @param userId Id a buscar
+ * @return int Posición donde está o donde debería insertarse el id
+ */
+static int postings_lower_bound(const InterestPostings *postings, int userId){
+    int low = 0, high = postings->size;
+    while (low < high){
+        int middle = low + (high - low) / 2;
+        if (postings->userIds[middle] < userId) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+/**
+ * @brief Agrega un usuario a la lista de un interés en el índice invertido
+ *
+ * @param graph Grafo
+ * @param user Usuario que tiene el interés
+ * @param interestId Id del interés global
+ */
+void index_user_interest(Graph graph, User user, int interestId){
+    if (interestId < 0 || user->id < 0) return;
+    if (interestId >= graph->numIndexedInterests){
+        InterestPostings *newIndex = (InterestPostings *)realloc(graph->interestIndex, (interestId + 1) * sizeof(InterestPostings));
+        if (!newIndex){
+            printf("ERROR: No hay memoria suficiente\n");
+            exit(EXIT_FAILURE);
+        }
+        memset(newIndex + graph->numIndexedInterests, 0, (interestId + 1 - graph->numIndexedInterests) * sizeof(InterestPostings));
+        graph->interestIndex = newIndex;
+        graph->numIndexedInterests = interestId + 1;
+    }
+
+    InterestPostings *postings = &graph->interestIndex[interestId];
+    int position = postings_lower_bound(postings, user->id);
+    if (position < postings->size && postings->userIds[position] == user->id) return;
+
+    if (postings->size == postings->capacity){
+        int newCapacity = postings->capacity ? postings->capacity * 2 : 8;
+        int *newIds = (int *)realloc(postings->userIds, newCapacity * sizeof(int));
+        if (!newIds){
+            printf("ERROR: No hay memoria suficiente\n");
+            exit(EXIT_FAILURE);
+        }
+        postings->userIds = newIds;
+        postings->capacity = newCapacity;
+    }
+    memmove(postings->userIds + position + 1, postings->userIds + position, (postings->size - position) * sizeof(int));
+    postings->userIds[position] = user->id;
+    postings->size++;
+    graph->interestsVersion++;
+}
+
+/**
+ * @brief Agrega todos los intereses de un usuario al índice invertido
+ *
+ * @param graph Grafo
+ * @param user Usuario
+ * @param globalInterests Tabla de intereses globales
+ */
+void index_user_interests(Graph graph, User user, GlobalInterests globalInterests){
+    for (int i = 0; i < globalInterests.numInterests; i++){
+        if (has_interest(user->interests, i)) index_user_interest(graph, user, i);
+    }
+}
+
+/**
+ * @brief Quita a un usuario de todas las listas del índice invertido
+ *
+ * @param graph Grafo
+ * @param user Usuario
+ */
+void unindex_user_interests(Graph graph, User user){
+    for (int i = 0; i < graph->numIndexedInterests; i++){
+        if (!has_interest(user->interests, i)) continue;
+        InterestPostings *postings = &graph->interestIndex[i];
+        int position = postings_lower_bound(postings, user->id);
+        if (position < postings->size && postings->userIds[position] == user->id){
+            memmove(postings->userIds + position, postings->userIds + position + 1, (postings->size - position - 1) * sizeof(int));
+            postings->size--;
+            graph->interestsVersion++;
+        }
+    }
+}
+
+/**
+ * @brief Libera el índice invertido de intereses
+ *
+ * @param graph Grafo
+ */
+void clear_interest_index(Graph graph){
+    for (int i = 0; i < graph->numIndexedInterests; i++){
+        free(graph->interestIndex[i].userIds);
+    }
+    free(graph->interestIndex);
+    graph->interestIndex = NULL;
+    graph->numIndexedInterests = 0;
+    graph->interestsVersion++;
 }
 
+/**
+ * @brief Compara candidatos por cantidad de intereses en común (mayor primero) y luego por id
+ */
+static int compare_candidates(const void *a, const void *b){
+    const InterestCandidate *c1 = (const InterestCandidate *)a;
+    const InterestCandidate *c2 = (const InterestCandidate *)b;
+    if (c1->overlap != c2->overlap) return c2->overlap - c1->overlap;
+    return c1->userId - c2->userId;
+}
+
+/**
+ * @brief Obtiene los usuarios que comparten al menos un interés con un usuario, usando el índice invertido
+ *
+ * @param graph Grafo
+ * @param user Usuario de referencia (no se incluye en el resultado)
+ * @param candidates Arreglo de candidatos ordenado por intereses en común de mayor a menor (liberar con free)
+ * @return int Cantidad de candidatos
+ *
+ * @note Solo recorre las listas de los intereses del usuario, no toda la red. El contador por id es graph->overlapCounts, que
+ *       se reutiliza entre búsquedas y se limpia solo en los ids tocados, así que no se puede buscar desde varios hilos a la vez
+ */
+int search_interest_candidates(Graph graph, User user, InterestCandidate **candidates){
+    *candidates = NULL;
+    if (graph->overlapCapacity < graph->nextId + 1){
+        int newCapacity = graph->overlapCapacity ? graph->overlapCapacity : GRAPH_INITIAL_ID_CAPACITY;
+        while (newCapacity < graph->nextId + 1) newCapacity *= 2;
+        int *newCounts = (int *)realloc(graph->overlapCounts, newCapacity * sizeof(int));
+        if (!newCounts){
+            printf("ERROR: No hay memoria suficiente\n");
+            exit(EXIT_FAILURE);
+        }
+        memset(newCounts + graph->overlapCapacity, 0, (newCapacity - graph->overlapCapacity) * sizeof(int));
+        graph->overlapCounts = newCounts;
+        graph->overlapCapacity = newCapacity;
+    }
+    int *overlap = graph->overlapCounts;
+    int count = 0, capacity = 0;
+
+    for (int i = 0; i < graph->numIndexedInterests; i++){
+        if (!has_interest(user->interests, i)) continue;
+        const InterestPostings *postings = &graph->interestIndex[i];
+        for (int j = 0; j < postings->size; j++){
+            int id = postings->userIds[j];
+            if (id == user->id) continue;
+            if (overlap[id]++ == 0){
+                if (count == capacity){
+                    capacity = capacity ? capacity * 2 : 64;
+                    InterestCandidate *newCandidates = (InterestCandidate *)realloc(*candidates, capacity * sizeof(InterestCandidate));
+                    if (!newCandidates){
+                        printf("ERROR: No hay memoria suficiente\n");
+                        exit(EXIT_FAILURE);
+                    }
+                    *candidates = newCandidates;
+                }
+                (*candidates)[count].userId = id;
+                count++;
+            }
+        }
+    }
 
+    for (int i = 0; i < count; i++){
+        int id = (*candidates)[i].userId;
+        (*candidates)[i].overlap = overlap[id];
+        overlap[id] = 0;
+    }
+    qsort(*candidates, count, sizeof(InterestCandidate), compare_candidates);
+    return count;
+}
+
+/**
+ * @brief Llena una dirección (seguidos o seguidores) de la copia CSR
+ *
+ * @param graph Grafo
+ * @param csr Copia CSR con numNodes definido
+ * @param followers 0 para seguidos, 1 para seguidores
+ * @param offsets Arreglo de inicios a llenar
+ * @param targets Arreglo de destinos a llenar
+ * @param weights Arreglo de pesos a llenar
+ */
+static void fill_csr_direction(Graph graph, CsrGraph csr, int followers, int *offsets, int *targets, double *weights){
+    int position = 0;
+    for (int i = 0; i < csr->numNodes; i++){
+        offsets[i] = position;
+        User user = graph->usersById[i];
+        if (!user) continue;
+        Adjacency adjacency = followers ? user->followers : user->following;
+        for (int e = 0; e < adjacency->size; e++){
+            targets[position] = adjacency->edges[e].dest->id;
+            weights[position] = adjacency->edges[e].weight;
+            position++;
+        }
+    }
+    offsets[csr->numNodes] = position;
+}
+
+/**
+ * @brief Construye una copia de solo lectura del grafo en formato CSR
+ *
+ * @param graph Grafo
+ * @return CsrGraph Copia CSR, liberar con @see free_csr_graph
+ *
+ * @note Las listas de adyacencia siguen siendo la estructura que se modifica; la copia no ve cambios posteriores
+ *       (@see get_csr_graph para la copia que se mantiene al día)
+ * @note Cada dirección se dimensiona con sus propias listas, así un grafo con seguidos y seguidores desiguales no desborda los arreglos
+ */
+CsrGraph build_csr_graph(Graph graph){
+    CsrGraph csr = (CsrGraph)malloc(sizeof(struct _csrGraph));
+    if (!csr){
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    csr->numNodes = graph->nextId;
+    csr->numEdges = 0;
+    csr->numInEdges = 0;
+    for (int i = 0; i < graph->nextId; i++){
+        User user = graph->usersById[i];
+        if (!user) continue;
+        csr->numEdges += user->following->size;
+        csr->numInEdges += user->followers->size;
+    }
+
+    csr->outOffsets = (int *)malloc((csr->numNodes + 1) * sizeof(int));
+    csr->inOffsets = (int *)malloc((csr->numNodes + 1) * sizeof(int));
+    csr->outTargets = (int *)malloc((csr->numEdges + 1) * sizeof(int));
+    csr->inTargets = (int *)malloc((csr->numInEdges + 1) * sizeof(int));
+    csr->outWeights = (double *)malloc((csr->numEdges + 1) * sizeof(double));
+    csr->inWeights = (double *)malloc((csr->numInEdges + 1) * sizeof(double));
+    if (!csr->outOffsets || !csr->inOffsets || !csr->outTargets || !csr->inTargets || !csr->outWeights || !csr->inWeights){
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+
+    fill_csr_direction(graph, csr, 0, csr->outOffsets, csr->outTargets, csr->outWeights);
+    fill_csr_direction(graph, csr, 1, csr->inOffsets, csr->inTargets, csr->inWeights);
+    return csr;
+}
+
+/**
+ * @brief Libera una copia CSR del grafo
+ *
+ * @param csr Copia CSR
+ */
+void free_csr_graph(CsrGraph csr){
+    if (!csr) return;
+    free(csr->outOffsets);
+    free(csr->outTargets);
+    free(csr->outWeights);
+    free(csr->inOffsets);
+    free(csr->inTargets);
+    free(csr->inWeights);
+    free(csr);
+}
+
+/**
+ * @brief Obtiene la copia CSR del grafo, reconstruyéndola solo si las aristas o los ids cambiaron desde la última
+ *
+ * @param graph Grafo
+ * @return CsrGraph Copia CSR guardada en el grafo (no liberarla: se libera con @see free_graph)
+ *
+ * @note Los recorridos de solo lectura (sugerencias, snapshot) la comparten, así el servidor la construye una vez entre cambios
+ */
+CsrGraph get_csr_graph(Graph graph){
+    if (!graph->csr || graph->csrVersion != edgesVersion){
+        free_csr_graph(graph->csr);
+        graph->csr = build_csr_graph(graph);
+        graph->csrVersion = edgesVersion;
+    }
+    return graph->csr;
+}
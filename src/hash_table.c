@@ -12,9 +12,85 @@
 
 #include "hash_table.h"
 
+/**
+ * @brief Reserva un arreglo de casillas vacías
+ *
+ * @param capacity Número de casillas
+ * @return Hashnode* Arreglo de casillas
+ */
+static Hashnode *allocate_slots(unsigned int capacity) {
+    Hashnode *slots = (Hashnode *)calloc(capacity, sizeof(Hashnode));
+    if (!slots) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    return slots;
+}
+
+/**
+ * @brief Coloca una casilla en la tabla usando Robin Hood (quien está más lejos de su casilla ideal se queda con el lugar)
+ *
+ * @param table Tabla hash
+ * @param node Casilla a colocar (su distancia se recalcula)
+ *
+ * @note No verifica si la clave ya existe ni el factor de carga
+ */
+static void place_node(HashTable *table, Hashnode node) {
+    unsigned int mask = table->capacity - 1;
+    unsigned int index = node.hash & mask;
+    node.distance = 1;
+    while (table->slots[index].distance != 0) {
+        if (table->slots[index].distance < node.distance) {
+            Hashnode temp = table->slots[index];
+            table->slots[index] = node;
+            node = temp;
+        }
+        index = (index + 1) & mask;
+        node.distance++;
+    }
+    table->slots[index] = node;
+}
+
+/**
+ * @brief Duplica la capacidad de la tabla y reubica todos los elementos
+ *
+ * @param table Tabla hash
+ */
+static void grow_hash_table(HashTable *table) {
+    Hashnode *old = table->slots;
+    unsigned int oldCapacity = table->capacity;
+
+    table->capacity = oldCapacity * 2;
+    table->slots = allocate_slots(table->capacity);
+    for (unsigned int i = 0; i < oldCapacity; i++) {
+        if (old[i].distance != 0) place_node(table, old[i]);
+    }
+    free(old);
+}
+
+/**
+ * @brief Busca la casilla que contiene una clave
+ *
+ * @param table Tabla hash
+ * @param key Clave a buscar
+ * @param hash Hash completo de la clave
+ * @return long Índice de la casilla o -1 si no existe
+ */
+static long find_slot(const HashTable *table, const char *key, unsigned int hash) {
+    unsigned int mask = table->capacity - 1;
+    unsigned int index = hash & mask;
+    unsigned int distance = 1;
+    while (table->slots[index].distance >= distance) {
+        if (table->slots[index].hash == hash && strcmp(table->slots[index].key, key) == 0) return index;
+        index = (index + 1) & mask;
+        distance++;
+    }
+    return -1;
+}
+
 /**
  * @brief Crea una nueva tabla hash vacía
- * 
+ *
  * @return HashTable* Puntero a la nueva tabla hash
  */
 HashTable* create_hash_table(void) {
@@ -23,95 +99,112 @@ HashTable* create_hash_table(void) {
         printf("ERROR: No hay memoria suficiente\n");
         exit(EXIT_FAILURE);
     }
-    for (int i = 0; i < HASH_TABLE_SIZE; i++) {
-        table->buckets[i] = NULL;
-    }
+    table->capacity = HASH_TABLE_INITIAL_CAPACITY;
+    table->count = 0;
+    table->slots = allocate_slots(table->capacity);
     return table;
 }
 
 /**
  * @brief Inserta un nuevo elemento en la tabla hash
- * 
+ *
  * @param table Tabla hash
  * @param key Clave del elemento
  * @param data Puntero a los datos
  * @return int 0 si se inserta correctamente, -1 si hay un error
+ *
+ * @note Si la clave ya existe se reemplazan sus datos
  */
 int insert_into_hash_table(HashTable *table, const char *key, void *data) {
     if (!table || !key) return -1;
-    unsigned int index = jenkins_hash(key);
-    Hashnode *new_node = (Hashnode *)malloc(sizeof(Hashnode));
-    if (!new_node) return -1;
-    new_node->key = strdup(key);
-    new_node->data = data;
-    new_node->next = table->buckets[index];
-    table->buckets[index] = new_node;
+    unsigned int hash = jenkins_hash(key);
+    long index = find_slot(table, key, hash);
+    if (index >= 0) {
+        table->slots[index].data = data;
+        return 0;
+    }
+
+    if ((double)(table->count + 1) > table->capacity * HASH_TABLE_MAX_LOAD) {
+        grow_hash_table(table);
+    }
+
+    Hashnode node;
+    node.key = arena_strdup(key);
+    node.data = data;
+    node.hash = hash;
+    node.distance = 0;
+    place_node(table, node);
+    table->count++;
     return 0;
 }
 
 /**
  * @brief Busca un elemento en la tabla hash por su clave
- * 
+ *
  * @param table Tabla hash
  * @param key Clave del elemento a buscar
  * @return void* Puntero a los datos encontrados o NULL si no existe
  */
 void *search_in_hash_table(HashTable *table, const char *key) {
     if (!table || !key) return NULL;
-    unsigned int index = jenkins_hash(key);
-    Hashnode *current = table->buckets[index];
-    while (current) {
-        if (strcmp(current->key, key) == 0) return current->data;
-        current = current->next;
-    }
-    return NULL;
+    long index = find_slot(table, key, jenkins_hash(key));
+    if (index < 0) return NULL;
+    return table->slots[index].data;
 }
 
 /**
  * @brief Elimina un elemento de la tabla hash
- * 
+ *
  * @param table Tabla hash
  * @param key Clave del elemento a eliminar
  * @return int 0 si se elimina correctamente, -1 si no se encuentra
+ *
+ * @note Los elementos siguientes se desplazan hacia atrás para no dejar lápidas
  */
 int delete_from_hash_table(HashTable *table, char *key) {
     if (!table || !key) return -1;
-    unsigned int index = jenkins_hash(key);
-    Hashnode *current = table->buckets[index];
-    Hashnode *previous = NULL;
-
-    while (current) {
-        if (strcmp(current->key, key) == 0) {
-            if (previous) {
-                previous->next = current->next;
-            } else {
-                table->buckets[index] = current->next;
-            }
-            free(current->key);
-            free(current);
-            return 0;
-        }
-        previous = current;
-        current = current->next;
+    long found = find_slot(table, key, jenkins_hash(key));
+    if (found < 0) return -1;
+
+    unsigned int mask = table->capacity - 1;
+    unsigned int index = (unsigned int)found;
+    arena_release(table->slots[index].key);
+
+    unsigned int next = (index + 1) & mask;
+    while (table->slots[next].distance > 1) {
+        table->slots[index] = table->slots[next];
+        table->slots[index].distance--;
+        index = next;
+        next = (next + 1) & mask;
     }
-    return -1;
+    table->slots[index].key = NULL;
+    table->slots[index].data = NULL;
+    table->slots[index].distance = 0;
+    table->count--;
+    return 0;
+}
+
+/**
+ * @brief Vacía la tabla hash de una vez, manteniendo su capacidad
+ *
+ * @param table Tabla hash
+ *
+ * @note Las claves están en la arena de strings, así que no se liberan una por una
+ */
+void clear_hash_table(HashTable *table) {
+    if (!table) return;
+    memset(table->slots, 0, table->capacity * sizeof(Hashnode));
+    table->count = 0;
 }
 
 /**
  * @brief Libera toda la memoria utilizada por la tabla hash
- * 
+ *
  * @param table Tabla hash
  */
 void free_hash_table(HashTable *table) {
     if (!table) return;
-    for (int i = 0; i < HASH_TABLE_SIZE; i++) {
-        Hashnode *current = table->buckets[i];
-        while (current) {
-            Hashnode *temp = current;
-            current = current->next;
-            free(temp->key);
-            free(temp);
-        }
-    }
+    /* las claves están en la arena de strings, @see release_all_memory */
+    free(table->slots);
     free(table);
 }
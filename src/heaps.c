@@ -12,30 +12,53 @@
 
 #include "heaps.h"
 
+/**
+ * @brief Inicializa un heap vacío
+ *
+ * @param h Cola de prioridad
+ * @param capacity Cantidad de elementos para los que se reserva espacio (0 para reservar con el primer elemento)
+ */
+void init_heap(heap* h, int capacity){
+    h->posts = NULL;
+    h->size = 0;
+    h->capacity = 0;
+    reserve_heap(h, capacity);
+}
+
+/**
+ * @brief Asegura que el heap tenga espacio para una cantidad de elementos
+ *
+ * @param h Cola de prioridad
+ * @param capacity Cantidad de elementos que deben caber
+ *
+ * @note Se usa antes de insertar muchos elementos de una vez (cuya cantidad se conoce) para reservar una sola vez
+ */
+void reserve_heap(heap* h, int capacity){
+    if (capacity <= h->capacity) return;
+    post* newPosts = (post *)realloc(h->posts, (size_t)capacity * sizeof(post));
+    if (!newPosts) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    h->posts = newPosts;
+    h->capacity = capacity;
+}
+
 /**
  * @brief Función para insertar una nueva publicación en el heap
  *
  * @param h Cola de prioridad
- * @param user_name Nombre del usuario
+ * @param author Autor de la publicación o usuario sugerido
+ * @param node Publicación (NULL para una sugerencia de usuario)
  * @param priority Prioridad de la publicación o de la sugerencia
- * @param content Contenido de la publicación o de la sugerencia
  */
-void insert_new_item(heap* h, const char* user_name, double priority, const char* content){
-    if (h->size >= MAX_HEAP_SIZE - 1) {
-        return;
+void insert_new_item(heap* h, User author, PtrToPostNode node, double priority){
+    if (h->size == h->capacity) {
+        reserve_heap(h, h->capacity ? h->capacity * 2 : HEAP_INITIAL_CAPACITY);
     }
     post new_post;
-    new_post.user_name = strdup(user_name);
-    new_post.content = strdup(content);
-
-    // Verificar si strdup falló
-    if (new_post.user_name == NULL || new_post.content == NULL) {
-        printf("Error al asignar memoria para las cadenas de texto.\n");
-        free(new_post.user_name);
-        free(new_post.content);
-        return;
-    }
-
+    new_post.author = author;
+    new_post.node = node;
     new_post.priority = priority;
 
     // insertar al final y luego hacer heapify_up
@@ -45,23 +68,141 @@ void insert_new_item(heap* h, const char* user_name, double priority, const char
 }
 
 
+/**
+ * @brief Indica si una posición del heap está en un nivel de mínimos
+ *
+ * @param index Índice del nodo
+ * @return int 1 si el nivel es par (mínimos), 0 si es impar (máximos)
+ */
+static int is_min_level(int index){
+    int level = 31 - __builtin_clz((unsigned int)index + 1);
+    return !(level & 1);
+}
+
+/**
+ * @brief Compara dos nodos según el tipo de nivel
+ *
+ * @param h Cola de prioridad
+ * @param a Índice del primer nodo
+ * @param b Índice del segundo nodo
+ * @param minLevel 1 para comparar como nivel de mínimos, 0 como nivel de máximos
+ * @return int 1 si a debe quedar sobre b (menor en un nivel de mínimos, mayor en uno de máximos)
+ */
+static int goes_before(heap* h, int a, int b, int minLevel){
+    return minLevel ? h->posts[a].priority < h->posts[b].priority : h->posts[a].priority > h->posts[b].priority;
+}
+
+/**
+ * @brief Intercambia dos nodos del heap
+ *
+ * @param h Cola de prioridad
+ * @param a Índice del primer nodo
+ * @param b Índice del segundo nodo
+ */
+static void swap_posts(heap* h, int a, int b){
+    post temp = h->posts[a];
+    h->posts[a] = h->posts[b];
+    h->posts[b] = temp;
+}
+
 /**
  * @brief Función para asegurar que el heap mantenga la propiedad (heapify_up)
  *
  * @param h Cola de prioridad
  * @param index Índice del nodo que debe ajustarse
+ *
+ * @note El heap es de mínimos y máximos: los niveles pares son de mínimos y los impares de máximos. El nodo se compara con su
+ *       padre para elegir el tipo de nivel y luego sube de abuelo en abuelo, O(log n)
  */
 void heapify_up(heap* h, int index){
-    while (index > 0 && h->posts[index].priority > h->posts[(index - 1) / 2].priority) {
-        // intercambiar
-        post temp = h->posts[index];
-        h->posts[index] = h->posts[(index - 1) / 2];
-        h->posts[(index - 1) / 2] = temp;
+    if (index == 0) return;
+    int parent = (index - 1) / 2;
+    int minLevel = is_min_level(index);
+    if (goes_before(h, parent, index, minLevel)) {
+        // el nodo pertenece a los niveles del otro tipo
+        swap_posts(h, index, parent);
+        index = parent;
+        minLevel = !minLevel;
+    }
+    while (index >= 3) {
+        int grandparent = ((index - 1) / 2 - 1) / 2;
+        if (!goes_before(h, index, grandparent, minLevel)) break;
+        swap_posts(h, index, grandparent);
+        index = grandparent;
+    }
+}
 
-        index = (index - 1) / 2;
+/**
+ * @brief Función para hacer heapify_down (restaurar la propiedad después de extraer el máximo o el mínimo)
+ *
+ * @param h Cola de prioridad
+ * @param index Índice del nodo
+ *
+ * @note En cada paso se busca el mejor entre hijos y nietos (el menor en un nivel de mínimos, el mayor en uno de máximos);
+ *       al bajar a un nieto se corrige el orden con su padre, que está en un nivel del otro tipo
+ */
+void heapify_down(heap* h, int index){
+    int minLevel = is_min_level(index);
+    while (1) {
+        int child = 2 * index + 1;
+        if (child >= h->size) break;
+        int best = child;
+        if (child + 1 < h->size && goes_before(h, child + 1, best, minLevel)) best = child + 1;
+        for (int grandchild = 4 * index + 3; grandchild <= 4 * index + 6 && grandchild < h->size; grandchild++) {
+            if (goes_before(h, grandchild, best, minLevel)) best = grandchild;
+        }
+        if (!goes_before(h, best, index, minLevel)) break;
+        swap_posts(h, index, best);
+        if (best <= child + 1) break; // era un hijo, que no tiene descendientes del mismo tipo de nivel
+        if (goes_before(h, (best - 1) / 2, best, minLevel)) swap_posts(h, best, (best - 1) / 2);
+        index = best;
     }
 }
 
+/**
+ * @brief Índice del nodo de mayor prioridad
+ *
+ * @param h Cola de prioridad (no vacía)
+ * @return int 0 si hay un elemento, si no el mayor de los hijos de la raíz
+ */
+static int max_index(heap* h){
+    if (h->size < 3) return h->size - 1;
+    return h->posts[2].priority > h->posts[1].priority ? 2 : 1;
+}
+
+/**
+ * @brief Quita un nodo del heap (sin liberar sus strings) y restaura la propiedad
+ *
+ * @param h Cola de prioridad
+ * @param index Índice del mínimo o del máximo
+ */
+static void remove_heap_node(heap* h, int index){
+    h->size--;
+    if (index == h->size) return;
+    h->posts[index] = h->posts[h->size];
+    heapify_down(h, index);
+}
+
+/**
+ * @brief Consulta la publicación de mayor prioridad sin extraerla, O(1)
+ *
+ * @param h Cola de prioridad
+ * @return post* Publicación o NULL si el heap está vacío
+ */
+post* peek_max(heap* h){
+    return h->size > 0 ? &h->posts[max_index(h)] : NULL;
+}
+
+/**
+ * @brief Consulta la publicación de menor prioridad sin extraerla, O(1)
+ *
+ * @param h Cola de prioridad
+ * @return post* Publicación o NULL si el heap está vacío
+ */
+post* peek_min(heap* h){
+    return h->size > 0 ? &h->posts[0] : NULL;
+}
+
 /**
  * @brief Función para extraer el máximo (el nodo más prioritario) y lo muestra (se utiliza en la función ver_posts)
  *
@@ -74,16 +215,15 @@ void extract_max(heap* h, int option){
         return;
     }
 
-    if (option == 1) printf("%s\n\n|----------\n  %s\n|----------\n", h->posts[0].user_name, h->posts[0].content);
+    int maxIndex = max_index(h);
+    post* item = &h->posts[maxIndex];
+    if (option == 1) printf("%s\n\n|----------\n  %s\n|----------\n", item->author->username, item->node ? item->node->post : "");
     if (option == 2){
-        printf("Hay interes de %f con %s\n", h->posts[0].priority, h->posts[0].user_name);
+        printf("Hay interes de %f con %s\n", item->priority, item->author->username);
     }
 
-    // mover el último nodo a la raíz y hacer heapify_down
-    h->posts[0] = h->posts[h->size - 1];
-    h->size--;
-    // restaurar la propiedad del heap
-    heapify_down(h, 0);
+    // mover el último nodo al lugar del máximo y restaurar la propiedad del heap
+    remove_heap_node(h, maxIndex);
 }
 
 /**
@@ -91,6 +231,8 @@ void extract_max(heap* h, int option){
  *
  * @param h Cola de prioridad
  * @param option Opción para personalizar el formato de salida
+ *
+ * @note El mínimo es la raíz del heap, así que extraerlo cuesta O(log n) igual que el máximo
  */
 void extract_min(heap* h, int option){
     if (h->size == 0) {
@@ -98,56 +240,154 @@ void extract_min(heap* h, int option){
         return;
     }
 
-    // Encontrar el índice del nodo con la menor prioridad
-    int minIndex = 0;
-    for (int i = 1; i < h->size; i++) {
-        if (h->posts[i].priority < h->posts[minIndex].priority) {
-            minIndex = i;
-        }
-    }
-
     // Mostrar el nodo con menor prioridad
+    post* item = &h->posts[0];
     if (option == 1) {
-        printf("%s\n\n|==========================\n  %s\n|==========================\n", h->posts[minIndex].user_name, h->posts[minIndex].content);
+        printf("%s\n\n|==========================\n  %s\n|==========================\n", item->author->username, item->node ? item->node->post : "");
     } else if (option == 2) {
-        printf("Hay interés de %f con %s\n", h->posts[minIndex].priority, h->posts[minIndex].user_name);
-        printf("%s\n\n", h->posts[minIndex].content);
+        printf("Hay interés de %f con %s\n", item->priority, item->author->username);
     } else if (option == 3) {
-        printf("Hay cercania de %f con %s\n", h->posts[minIndex].priority, h->posts[minIndex].user_name);
+        printf("Hay cercania de %f con %s\n", item->priority, item->author->username);
     }
-    // Mover el último nodo al lugar del mínimo
-    h->posts[minIndex] = h->posts[h->size - 1];
-    h->size--;
 
-    // Restaurar la propiedad del heap (solo si rompimos la estructura)
-    // Se puede optar por ignorar heapify_down aquí, ya que no es un nodo raíz.
+    // mover el último nodo a la raíz y restaurar la propiedad del heap
+    remove_heap_node(h, 0);
 }
 
 /**
- * @brief Función para hacer heapify_down (restaurar la propiedad después de extraer el máximo)
+ * @brief Inicializa un acumulador vacío de los K mejores candidatos
  *
- * @param h Cola de prioridad
- * @param index Índice del nodo
+ * @param t Acumulador
+ * @param k Cantidad de elementos que se guardan (al menos 1)
+ * @param keepLowest 1 para guardar las k prioridades menores, 0 para las k mayores
+ *
+ * @note El arreglo se reserva con el primer elemento y crece hasta k, así un k grande no reserva memoria que no se usa
  */
-void heapify_down(heap* h, int index){
-    int left = 2 * index + 1;
-    int right = 2 * index + 2;
-    int largest = index;
+void init_top_k(TopK* t, int k, int keepLowest){
+    t->items = NULL;
+    t->size = 0;
+    t->capacity = 0;
+    t->k = k > 0 ? k : 1;
+    t->keepLowest = keepLowest;
+}
 
-    if (left < h->size && h->posts[left].priority > h->posts[largest].priority) {
-        largest = left;
+/**
+ * @brief Indica si una prioridad es peor que otra según el tipo de acumulador
+ *
+ * @param t Acumulador
+ * @param a Prioridad a comparar
+ * @param b Prioridad de referencia
+ * @return int 1 si a es peor que b
+ */
+static int top_k_worse(const TopK* t, double a, double b){
+    return t->keepLowest ? a > b : a < b;
+}
+
+/**
+ * @brief Baja un elemento del acumulador hasta que su posición respete el orden del heap (el peor en la raíz)
+ *
+ * @param t Acumulador
+ * @param index Índice del elemento
+ */
+static void top_k_sift_down(TopK* t, int index){
+    post node = t->items[index];
+    while (1) {
+        int worst = 2 * index + 1;
+        if (worst >= t->size) break;
+        if (worst + 1 < t->size && top_k_worse(t, t->items[worst + 1].priority, t->items[worst].priority)) {
+            worst++;
+        }
+        if (!top_k_worse(t, t->items[worst].priority, node.priority)) break;
+        t->items[index] = t->items[worst];
+        index = worst;
     }
-    if (right < h->size && h->posts[right].priority > h->posts[largest].priority) {
-        largest = right;
+    t->items[index] = node;
+}
+
+/**
+ * @brief Indica si un candidato entraría en el acumulador
+ *
+ * @param t Acumulador
+ * @param priority Prioridad del candidato
+ * @return int 1 si todavía hay espacio o el candidato es mejor que el peor guardado
+ *
+ * @note Permite descartar un candidato antes de preparar su contenido
+ */
+int top_k_accepts(const TopK* t, double priority){
+    return t->size < t->k || top_k_worse(t, t->items[0].priority, priority);
+}
+
+/**
+ * @brief Inserta un candidato en el acumulador si está entre los K mejores
+ *
+ * @param t Acumulador
+ * @param author Autor de la publicación o usuario sugerido
+ * @param node Publicación (NULL para una sugerencia de usuario)
+ * @param priority Prioridad de la publicación o de la sugerencia
+ *
+ * @note Si el acumulador está lleno, el candidato reemplaza al peor guardado
+ */
+void top_k_insert(TopK* t, User author, PtrToPostNode node, double priority){
+    if (!top_k_accepts(t, priority)) {
+        return;
+    }
+
+    if (t->size == t->k) {
+        // reemplazar al peor y restaurar el orden desde la raíz
+        t->items[0].author = author;
+        t->items[0].node = node;
+        t->items[0].priority = priority;
+        top_k_sift_down(t, 0);
+        return;
     }
-    if (largest != index) {
-        // intercambiar
-        post temp = h->posts[index];
-        h->posts[index] = h->posts[largest];
-        h->posts[largest] = temp;
 
-        heapify_down(h, largest);
+    if (t->size == t->capacity) {
+        int newCapacity = t->capacity ? t->capacity * 2 : HEAP_INITIAL_CAPACITY;
+        if (newCapacity > t->k) newCapacity = t->k;
+        post* newItems = (post *)realloc(t->items, (size_t)newCapacity * sizeof(post));
+        if (!newItems) {
+            printf("ERROR: No hay memoria suficiente\n");
+            exit(EXIT_FAILURE);
+        }
+        t->items = newItems;
+        t->capacity = newCapacity;
+    }
+    int index = t->size++;
+    while (index > 0 && top_k_worse(t, priority, t->items[(index - 1) / 2].priority)) {
+        t->items[index] = t->items[(index - 1) / 2];
+        index = (index - 1) / 2;
     }
+    t->items[index].author = author;
+    t->items[index].node = node;
+    t->items[index].priority = priority;
+}
+
+/**
+ * @brief Mueve los elementos del acumulador a un heap
+ *
+ * @param t Acumulador (queda vacío)
+ * @param h Cola de prioridad
+ */
+void top_k_to_heap(TopK* t, heap* h){
+    reserve_heap(h, h->size + t->size);
+    for (int i = 0; i < t->size; i++) {
+        h->posts[h->size] = t->items[i];
+        h->size++;
+        heapify_up(h, h->size - 1);
+    }
+    t->size = 0;
+}
+
+/**
+ * @brief Libera la memoria del acumulador
+ *
+ * @param t Acumulador
+ */
+void free_top_k(TopK* t){
+    free(t->items);
+    t->items = NULL;
+    t->size = 0;
+    t->capacity = 0;
 }
 
 /**
@@ -182,10 +422,13 @@ void watch_posts(heap* h){
         printf("\n[1.Continuar][2.Salir]\n");
 
         // Usar scanf de manera más segura para evitar que el programa se quede atascado
-        if (scanf("%d", &opcion) != 1) {
+        int leidos = scanf("%d", &opcion);
+        if (leidos == EOF) break; // sin más entrada (por ejemplo en el servidor o un lote) se sale
+        if (leidos != 1) {
             printf("Entrada no válida. Debe ingresar un número.\n");
 
-            while (getchar() != '\n');  // Limpiar el buffer
+            int c;
+            while ((c = getchar()) != '\n' && c != EOF);  // Limpiar el buffer
 
             opcion = 3;
         }
@@ -198,90 +441,150 @@ void watch_posts(heap* h){
 }
 
 /**
- * @brief función para buscar publicaciones para colocar en el heap
+ * @brief función para buscar publicaciones candidatas al feed entre las de mis seguidos
  *
- * @param h cola de prioridad
- * @param table Puntero a la tabla hash
+ * @param candidates Candidatos del feed
+ * @param currentUser Usuario actual
+ *
+ * @note La afinidad con cada seguido sale del peso de la arista, sin recalcular la distancia de jaccard
  */
-void search_posts_in_my_follows(heap* h, User currentUser){
+void search_posts_in_my_follows(FeedCandidates* candidates, User currentUser){
     if (!currentUser || currentUser->numFollowing == 0) {
         return;
     }
 
-    for (int i = 0; i < currentUser->numFollowing; i++) {
-        User u = currentUser->following->next->dest;
-        while (u->posts->next != NULL) {
-            insert_new_item(h, u->username, 0, u->posts->next->post);
-            u->posts = u->posts->next;
-        }
-        currentUser->following = currentUser->following->next;
+    for (int i = 0; i < currentUser->following->size; i++) {
+        Edge edge = &currentUser->following->edges[i];
+        add_author_posts(candidates, edge->dest, edge->weight, 1);
     }
 }
 
 /**
- * @brief función para buscar publicaciones para colocar en el heap
+ * @brief función para buscar publicaciones candidatas al feed entre las de usuarios con intereses en común
  *
- * @param h cola de prioridad
- * @param table Puntero a la tabla hash
- */
-void search_posts_by_interests(heap* h, PtrToHashTable table, GlobalInterests globalInterestsTable, User currentUser){
-    for (int i = 0; i < HASH_TABLE_SIZE; i++) {
-        Hashnode *current = table->buckets[i];
-        while (current) {
-            User u = (User)current->data;
-            double jaccard = edge_jaccard(currentUser, u, globalInterestsTable);
-            if (jaccard <= 1 && currentUser->username != u->username) {
-                while (u->posts->next != NULL) {
-                    insert_new_item(h, u->username, jaccard, u->posts->next->post);
-                    u->posts = u->posts->next;
-                }
-            }
-            current = current->next;
-        }
+ * @param candidates Candidatos del feed
+ * @param graph Grafo de usuarios
+ * @param globalInterestsTable Tabla de intereses globales
+ * @param currentUser Usuario actual
+ *
+ * @note Solo se consideran los usuarios que comparten algún interés, obtenidos del índice invertido del grafo. Los seguidos
+ *       se saltan porque ya los añade @see search_posts_in_my_follows
+ */
+void search_posts_by_interests(FeedCandidates* candidates, Graph graph, GlobalInterests globalInterestsTable, User currentUser){
+    InterestCandidate *interestCandidates;
+    int count = search_interest_candidates(graph, currentUser, &interestCandidates);
+    for (int i = 0; i < count; i++) {
+        User u = graph->usersById[interestCandidates[i].userId];
+        if (search_edge(currentUser->following, u)) continue;
+        add_author_posts(candidates, u, edge_jaccard(currentUser, u, globalInterestsTable), 0);
     }
+    free(interestCandidates);
 }
 
 /**
  * @brief función para liberar recursos
  *
  * @param h cola de prioridad
+ *
+ * @note El heap queda vacío y se puede volver a usar sin iniciarlo
  */
 void free_heap(heap* h){
-    for (int i = 0; i < h->size; i++) {
-        if (h->posts[i].content) free(h->posts[i].content);
-        if (h->posts[i].user_name) free(h->posts[i].user_name);
+    free(h->posts);
+    h->posts = NULL;
+    h->size = 0;
+    h->capacity = 0;
+}
+
+/**
+ * @brief Inserta a un usuario como sugerencia si su distancia de jaccard con el usuario actual es <= 0.5
+ *
+ * @param suggestions Acumulador de las mejores sugerencias
+ * @param globalInterestsTable Tabla de intereses globales
+ * @param currentUser Usuario actual
+ * @param u Usuario candidato
+ */
+static void insert_friend_suggestion(TopK* suggestions, GlobalInterests globalInterestsTable, User currentUser, User u){
+    double jaccard = edge_jaccard(currentUser, u, globalInterestsTable);
+    if (!(jaccard <= 0.5)) return;
+    top_k_insert(suggestions, u, NULL, jaccard); // una sugerencia se guarda igual que un post, sin publicación
+}
+
+/**
+ * @brief Imprime los intereses que comparten dos usuarios
+ *
+ * @param currentUser Usuario actual
+ * @param u Usuario sugerido
+ * @param globalInterestsTable Tabla de intereses globales
+ */
+static void print_common_interests(User currentUser, User u, GlobalInterests globalInterestsTable){
+    printf("intereses comunes: \n\t");
+    for (int w = 0; w < globalInterestsTable.numWords; w++) {
+        InterestWord common = u->interests[w] & currentUser->interests[w];
+        while (common) {
+            int j = w * INTEREST_WORD_BITS + __builtin_ctzll(common);
+            common &= common - 1;
+            printf("%s ", globalInterestsTable.interestsTable[j]);
+        }
     }
+    printf("\n\n");
 }
 
 /**
- * @brief función para buscar sugerencias de amistades para colocar en el heap
+ * @brief función para buscar sugerencias de amistades
  *
- * @param h cola de prioridad
- * @param table Puntero a la tabla hash
+ * @param suggestions Acumulador de las mejores sugerencias
+ * @param graph Grafo de usuarios
+ * @param lsh Índice LSH para la búsqueda aproximada (@see build_lsh_index), NULL para la búsqueda exacta
  * @param globalInterestsTable Tabla de intereses globales
  * @param currentUser Usuario actual
+ *
+ * @note En la búsqueda exacta los candidatos vienen del índice invertido ordenados por intereses en común; como la distancia
+ *       de jaccard solo puede ser <= 0.5 si se comparte al menos la mitad de los intereses del usuario, se corta al bajar de ese número
  */
-void search_new_possible_friends(heap* h, PtrToHashTable table, GlobalInterests globalInterestsTable, User currentUser){
-    for (int i = 0; i < HASH_TABLE_SIZE; i++) {
-        Hashnode *current = table->buckets[i];
-        while (current) {
-            User u = (User)current->data;
-            double jaccard = edge_jaccard(currentUser, u, globalInterestsTable);
-            if (jaccard <= 0.5 && currentUser->username != u->username) {
-                int j = 0;
-                char interest[1024] = "intereses comunes: \n\t";
-                while (j <= globalInterestsTable.numInterests) {
-                    if (u->interests[j].value == 1 && currentUser->interests[j].value == 1) {
-                        strcat(interest, u->interests[j].name);
-                        strcat(interest, " ");
-                    }
-                    j++;
-                }
-                insert_new_item(h, u->username, jaccard, interest); // usamos esta función de los posts por que insertar una sugerencia en el heap es igual a insertar un post
-            }
-            current = current->next;
+void search_new_possible_friends(TopK* suggestions, Graph graph, LshIndex lsh, GlobalInterests globalInterestsTable, User currentUser){
+    if (lsh) {
+        int *ids;
+        int count = lsh_candidates(lsh, graph, currentUser, &ids);
+        for (int i = 0; i < count; i++) {
+            insert_friend_suggestion(suggestions, globalInterestsTable, currentUser, graph->usersById[ids[i]]);
         }
+        free(ids);
+        return;
+    }
+
+    int ownInterests = 0;
+    for (int w = 0; w < globalInterestsTable.numWords; w++) {
+        ownInterests += __builtin_popcountll(currentUser->interests[w]);
+    }
+
+    InterestCandidate *candidates;
+    int count = search_interest_candidates(graph, currentUser, &candidates);
+    for (int i = 0; i < count && 2 * candidates[i].overlap >= ownInterests; i++) {
+        insert_friend_suggestion(suggestions, globalInterestsTable, currentUser, graph->usersById[candidates[i].userId]);
+    }
+    free(candidates);
+}
+
+/**
+ * @brief función para buscar sugerencias de amistades en la tabla de similitudes precalculada (@see compute_similarity_join)
+ *
+ * @param suggestions Acumulador de las mejores sugerencias
+ * @param graph Grafo de usuarios
+ * @param globalInterestsTable Tabla de intereses globales
+ * @param currentUser Usuario actual
+ * @return int 1 si se usó la tabla, 0 si no existe, no corresponde a la base de datos actual o se piden más sugerencias de
+ *         las que guarda (SIMILARITY_TOP_K por usuario)
+ */
+int search_precomputed_possible_friends(TopK* suggestions, Graph graph, GlobalInterests globalInterestsTable, User currentUser){
+    if (suggestions->k > SIMILARITY_TOP_K) return 0;
+    int ids[SIMILARITY_TOP_K];
+    float similarities[SIMILARITY_TOP_K];
+    int count = read_similar_users(SIMILARITY_FILE, graph, currentUser, ids, similarities);
+    if (count < 0) return 0;
+    for (int i = 0; i < count; i++) {
+        insert_friend_suggestion(suggestions, globalInterestsTable, currentUser, graph->usersById[ids[i]]);
     }
+    return 1;
 }
 
 /**
@@ -307,102 +610,313 @@ void watch_suggestions_friends_of_friends(heap* h){
  * @brief función para visualizar sugerencias de amistad en base a la similitud de los usuarios
  *
  * @param h cola de prioridad
+ * @param currentUser Usuario actual
+ * @param globalInterestsTable Tabla de intereses globales
+ *
+ * @note Los intereses comunes se calculan al mostrar cada sugerencia, no al buscarlas
  */
-void watch_suggestions_by_interests(heap* h){
+void watch_suggestions_by_interests(heap* h, User currentUser, GlobalInterests globalInterestsTable){
     printf("\t\tSUGERENCIAS DE AMISTAD POR INTERESES\n\n");
     while(h->size > 0) {
+        User suggested = peek_min(h)->author;
         extract_min(h, 2); // extraemos el minimo dado que usamos distancia de jaccard, es decir mientras menor número de jaccard, entonces mayor similitud
+        print_common_interests(currentUser, suggested, globalInterestsTable);
     }
 }
 
 
 /**
- * @brief Devuelve índice de un usuario según su posición en el grafo
+ * @brief Inicializa un heap indexado vacío
  *
- * @param graph Grafo
- * @param source Usuario a obtener index
- * @return int
+ * @param h Heap indexado
+ * @param capacity Cantidad de ids que admite (ids en [0, capacity))
  *
- * @note Se utiliza para el algoritmo \link dijkstra \endlink
+ * @note Los arreglos se reservan sin recorrerlos, así que iniciar el heap no cuesta O(capacity)
  */
-int dijkstra_table_index(Graph graph, User source){
-    int i = 0;
-    GraphList aux = graph->graphUsersList->next;
-    while (aux){
-        if (aux == source){
-            return i;
-        }
-        aux = aux->next;
-        i++;
+void init_indexed_heap(IndexedHeap* h, int capacity){
+    h->nodes = (int *)malloc((capacity + 1) * sizeof(int));
+    h->position = (int *)calloc(capacity + 1, sizeof(int));
+    h->keys = (double *)malloc((capacity + 1) * sizeof(double));
+    if (!h->nodes || !h->position || !h->keys) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
     }
-    printf("Error: No se encontro el usuario en el grafo\n");
-    return -1;
+    h->size = 0;
+    h->capacity = capacity;
 }
 
 /**
- * @brief Algoritmo de Dijkstra para caminos cortos, aplicado a la sugerencia de amistades
- * 
- * @param h Heap
- * @param graph Grafo de usuarios
- * @param source Usuario del que se obtendrá los caminos cortos
- */
-void dijkstra(heap* h, Graph graph, User source){
-
-    /* Inicialización de la tabla de distancias */
-    struct dijkstra_table{
-        User user;
-        double distance;
-        int visited;
-    };
-    int usersNumber = graph->usersNumber;
-    struct dijkstra_table *table = malloc(sizeof(struct dijkstra_table) * usersNumber);
-    User user_aux = graph->graphUsersList->next;
-    for (int i = 0; i < usersNumber; i++){
-        table[i].user = user_aux;
-        table[i].distance = INT_MAX;
-        table[i].visited = 0;
-        user_aux = user_aux->next;
-    }
-
-    int sourceIndex = dijkstra_table_index(graph, source);
-    table[sourceIndex].user = source;
-    table[sourceIndex].distance = 0;
-
-    for (int i = 0; i < usersNumber; i++){
-        // Seleccionar el nodo no visitado con la distancia más pequeña
-        int u = -1;
-        int minDistance = INT_MAX;
-        // Buscar el nodo con la distancia más corta
-        for (int j = 0; j < usersNumber; j++){
-            if (!table[j].visited && table[j].distance < minDistance){
-                u = j;
-                minDistance = table[j].distance;
-            }
-        }
-        // Si no se encontró ningún nodo accesible, salimos
-        if (u == -1)
-            break;
-        table[u].visited = 1;
-
-        User currentUser = table[u].user;
-        // Recorrer los siguiendo del usuario
-        Edge edge = currentUser->following->next;
-        while (edge != NULL){
-            int v = dijkstra_table_index(graph, edge->dest);
-            if (table[u].distance + edge->weight < table[v].distance)
-            {
-                table[v].distance = table[u].distance + edge->weight;
-            }
-            edge = edge->next;
+ * @brief Amplía un heap indexado para que admita más ids, conservando sus elementos
+ *
+ * @param h Heap indexado
+ * @param capacity Cantidad de ids que debe admitir (ids en [0, capacity))
+ */
+void reserve_indexed_heap(IndexedHeap* h, int capacity){
+    if (capacity <= h->capacity) return;
+    int *nodes = (int *)realloc(h->nodes, (capacity + 1) * sizeof(int));
+    if (nodes) h->nodes = nodes;
+    int *position = (int *)realloc(h->position, (capacity + 1) * sizeof(int));
+    if (position) h->position = position;
+    double *keys = (double *)realloc(h->keys, (capacity + 1) * sizeof(double));
+    if (keys) h->keys = keys;
+    if (!nodes || !position || !keys) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(h->position + h->capacity + 1, 0, (capacity - h->capacity) * sizeof(int));
+    h->capacity = capacity;
+}
+
+/**
+ * @brief Libera la memoria de un heap indexado
+ *
+ * @param h Heap indexado
+ */
+void free_indexed_heap(IndexedHeap* h){
+    free(h->nodes);
+    free(h->position);
+    free(h->keys);
+    h->size = 0;
+    h->capacity = 0;
+}
+
+/**
+ * @brief Sube un elemento del heap indexado hasta restaurar la propiedad de heap
+ *
+ * @param h Heap indexado
+ * @param index Posición del elemento
+ */
+static void indexed_heap_sift_up(IndexedHeap* h, int index){
+    int node = h->nodes[index];
+    double key = h->keys[node];
+    while (index > 0) {
+        int parent = (index - 1) / INDEXED_HEAP_ARITY;
+        if (h->keys[h->nodes[parent]] <= key) break;
+        h->nodes[index] = h->nodes[parent];
+        h->position[h->nodes[index]] = index + 1;
+        index = parent;
+    }
+    h->nodes[index] = node;
+    h->position[node] = index + 1;
+}
+
+/**
+ * @brief Baja un elemento del heap indexado hasta restaurar la propiedad de heap
+ *
+ * @param h Heap indexado
+ * @param index Posición del elemento
+ */
+static void indexed_heap_sift_down(IndexedHeap* h, int index){
+    int node = h->nodes[index];
+    double key = h->keys[node];
+    while (1) {
+        int first = index * INDEXED_HEAP_ARITY + 1;
+        if (first >= h->size) break;
+        int last = first + INDEXED_HEAP_ARITY;
+        if (last > h->size) last = h->size;
+        int smallest = first;
+        for (int c = first + 1; c < last; c++) {
+            if (h->keys[h->nodes[c]] < h->keys[h->nodes[smallest]]) smallest = c;
         }
+        if (h->keys[h->nodes[smallest]] >= key) break;
+        h->nodes[index] = h->nodes[smallest];
+        h->position[h->nodes[index]] = index + 1;
+        index = smallest;
     }
+    h->nodes[index] = node;
+    h->position[node] = index + 1;
+}
 
-    // Imprimir distancias
-    for (int i = 0; i < usersNumber; i++){
-        if (table[i].distance != INT_MAX && source->username != table[i].user->username){
-            insert_new_item(h, table[i].user->username, table[i].distance, table[i].user->username);
+/**
+ * @brief Inserta un id en el heap indexado o disminuye su clave si ya está
+ *
+ * @param h Heap indexado
+ * @param node Id del usuario
+ * @param key Nueva clave
+ *
+ * @note Si el id ya está con una clave menor o igual no se modifica
+ */
+void indexed_heap_push_or_decrease(IndexedHeap* h, int node, double key){
+    if (node < 0 || node >= h->capacity) return;
+    if (h->position[node] > 0) {
+        if (key >= h->keys[node]) return;
+        h->keys[node] = key;
+        indexed_heap_sift_up(h, h->position[node] - 1);
+        return;
+    }
+    h->keys[node] = key;
+    h->nodes[h->size] = node;
+    h->size++;
+    indexed_heap_sift_up(h, h->size - 1);
+}
+
+/**
+ * @brief Extrae el id con menor clave del heap indexado
+ *
+ * @param h Heap indexado
+ * @return int Id extraído o -1 si el heap está vacío
+ */
+int indexed_heap_pop_min(IndexedHeap* h){
+    if (h->size == 0) return -1;
+    int min = h->nodes[0];
+    h->position[min] = 0;
+    h->size--;
+    if (h->size > 0) {
+        h->nodes[0] = h->nodes[h->size];
+        indexed_heap_sift_down(h, 0);
+    }
+    return min;
+}
+
+/**
+ * @struct _frontier
+ * @brief Usuarios alcanzados por @see dijkstra_bounded, numerados en el orden en que se alcanzan
+ * @note Un índice abierto id -> número evita reservar arreglos del tamaño de la red: la memoria depende solo del vecindario recorrido.
+ *       Con límite de saltos cada usuario tiene una distancia por cantidad de saltos (un estado (usuario, saltos) en el heap),
+ *       así un usuario al que el camino más corto llega con demasiados saltos igual se alcanza por uno más largo dentro del radio
+ */
+struct _frontier{
+    int *ids; /*!< Id del usuario de cada número */
+    double *distance; /*!< Distancia desde el origen de cada estado: layers por usuario, INFINITY si no se alcanzó */
+    int *settledHops; /*!< Menor cantidad de saltos con que ya se fijó el usuario (INT_MAX si aún no se fija) */
+    int layers; /*!< Estados por usuario: maxHops + 1, o 1 sin límite de saltos */
+    int size; /*!< Cantidad de usuarios alcanzados */
+    int capacity; /*!< Capacidad de los arreglos */
+    int *slots; /*!< Número + 1 del usuario de cada casilla (0 si está vacía), por sondeo lineal */
+    int numSlots; /*!< Casillas del índice, potencia de 2 y al menos el doble de capacity */
+};
+
+/**
+ * @brief Casilla inicial de un id en el índice de la frontera
+ *
+ * @param id Id del usuario
+ * @param numSlots Casillas del índice
+ * @return int Casilla
+ */
+static int frontier_home(int id, int numSlots){
+    return (int)(((unsigned int)id * 2654435761u) & (unsigned int)(numSlots - 1));
+}
+
+/**
+ * @brief Amplía los arreglos y el índice de la frontera al doble
+ *
+ * @param frontier Frontera
+ */
+static void grow_frontier(struct _frontier *frontier){
+    int capacity = frontier->capacity ? frontier->capacity * 2 : FRONTIER_INITIAL_CAPACITY;
+    int *ids = (int *)realloc(frontier->ids, capacity * sizeof(int));
+    if (ids) frontier->ids = ids;
+    double *distance = (double *)realloc(frontier->distance, (size_t)capacity * frontier->layers * sizeof(double));
+    if (distance) frontier->distance = distance;
+    int *settledHops = (int *)realloc(frontier->settledHops, capacity * sizeof(int));
+    if (settledHops) frontier->settledHops = settledHops;
+    int numSlots = capacity * 2;
+    int *slots = (int *)calloc(numSlots, sizeof(int));
+    if (!ids || !distance || !settledHops || !slots) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < frontier->size; i++) {
+        int slot = frontier_home(frontier->ids[i], numSlots);
+        while (slots[slot]) slot = (slot + 1) & (numSlots - 1);
+        slots[slot] = i + 1;
+    }
+    free(frontier->slots);
+    frontier->slots = slots;
+    frontier->numSlots = numSlots;
+    frontier->capacity = capacity;
+}
+
+/**
+ * @brief Obtiene el número de un usuario en la frontera, agregándolo si aún no se alcanzó
+ *
+ * @param frontier Frontera
+ * @param id Id del usuario
+ * @return int Número del usuario
+ */
+static int frontier_index(struct _frontier *frontier, int id){
+    if (frontier->size == frontier->capacity) grow_frontier(frontier);
+    int slot = frontier_home(id, frontier->numSlots);
+    while (frontier->slots[slot]) {
+        int index = frontier->slots[slot] - 1;
+        if (frontier->ids[index] == id) return index;
+        slot = (slot + 1) & (frontier->numSlots - 1);
+    }
+    int index = frontier->size++;
+    frontier->slots[slot] = index + 1;
+    frontier->ids[index] = id;
+    frontier->settledHops[index] = INT_MAX;
+    for (int layer = 0; layer < frontier->layers; layer++) frontier->distance[(size_t)index * frontier->layers + layer] = INFINITY;
+    return index;
+}
+
+/**
+ * @brief Dijkstra acotado: encuentra los k usuarios no seguidos más cercanos dentro de un radio
+ *
+ * @param h Heap donde se insertan las sugerencias
+ * @param csr Copia CSR del grafo (@see get_csr_graph)
+ * @param graph Grafo, para obtener el usuario de cada id sugerido
+ * @param source Usuario del que se obtendrán las sugerencias
+ * @param k Cantidad de sugerencias buscadas (0 o menos para no limitar)
+ * @param maxHops Cantidad máxima de saltos desde source (0 o menos para no limitar)
+ * @param maxDistance Distancia máxima desde source
+ *
+ * @note Recorre los seguidos de cada id en los arreglos contiguos de la copia CSR y se detiene al fijar k usuarios, así que ni el
+ *       tiempo ni la memoria de la búsqueda dependen del tamaño de la red, solo del vecindario explorado (@see struct _frontier)
+ * @note La distancia de cada usuario es la del camino más corto con a lo sumo maxHops saltos. El heap ordena estados
+ *       (usuario, saltos); el primero que sale de un usuario lo fija, y uno posterior solo se expande si llega con menos saltos
+ *       que los ya fijados (si no, otro estado lo domina), así cada usuario sale a lo sumo maxHops + 1 veces
+ */
+void dijkstra_bounded(heap* h, CsrGraph csr, Graph graph, User source, int k, int maxHops, double maxDistance){
+    struct _frontier frontier;
+    memset(&frontier, 0, sizeof(frontier));
+    frontier.layers = maxHops > 0 ? maxHops + 1 : 1;
+    int layers = frontier.layers;
+    int sourceIndex = frontier_index(&frontier, source->id);
+    frontier.distance[(size_t)sourceIndex * layers] = 0;
+
+    IndexedHeap queue;
+    init_indexed_heap(&queue, frontier.capacity * layers);
+    indexed_heap_push_or_decrease(&queue, sourceIndex * layers, 0);
+
+    int found = 0;
+    int state;
+    while ((state = indexed_heap_pop_min(&queue)) != -1){
+        int u = state / layers;
+        int hops = state % layers;
+        if (hops >= frontier.settledHops[u]) continue;
+        int firstVisit = frontier.settledHops[u] == INT_MAX;
+        frontier.settledHops[u] = hops;
+        double distance = frontier.distance[state];
+
+        int id = frontier.ids[u];
+        User user = get_user_by_id(graph, id);
+        if (firstVisit && u != sourceIndex && user && !search_edge(source->following, user)){
+            insert_new_item(h, user, NULL, distance);
+            found++;
+            if (k > 0 && found >= k) break;
+        }
+        if (maxHops > 0 && hops >= maxHops) continue;
+        int nextHops = maxHops > 0 ? hops + 1 : 0;
+
+        if (id >= csr->numNodes) continue; /* usuario creado después de la copia, sin seguidos */
+        for (int e = csr->outOffsets[id]; e < csr->outOffsets[id + 1]; e++){
+            double candidate = distance + csr->outWeights[e];
+            if (!(candidate <= maxDistance)) continue;
+            int v = frontier_index(&frontier, csr->outTargets[e]);
+            if (nextHops >= frontier.settledHops[v]) continue;
+            int next = v * layers + nextHops;
+            if (candidate < frontier.distance[next]){
+                frontier.distance[next] = candidate;
+                reserve_indexed_heap(&queue, frontier.capacity * layers);
+                indexed_heap_push_or_decrease(&queue, next, candidate);
+            }
         }
     }
 
-    free(table);
-}
\ No newline at end of file
+    free_indexed_heap(&queue);
+    free(frontier.ids);
+    free(frontier.distance);
+    free(frontier.settledHops);
+    free(frontier.slots);
+}
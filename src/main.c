@@ -21,6 +21,10 @@
 #include "hash_table.h"
 #include "utilities.h"
 #include "database.h" 
+#include "similarity.h"
+#include "commands.h"
+#include "server.h"
+#include "batch.h"
 
 /**
  * @brief Función que ejecuta el flujo principal del programa
@@ -35,20 +39,42 @@ int main(int argc, char *argv[]){
     PtrToHashTable table = NULL;
     Graph graph = NULL;
     GlobalInterests globalInterestsTable;
-    User currentUser = NULL;
-    heap feed;
 
     // obtener parámetros ingresados por el terminal
     int option=get_option(argc, argv);
+    // el archivo del lote puede venir pegado a la opción ('-barchivo', '--batch=archivo'), así que se toma de getopt
+    const char *batchFile = option == OPTION_BATCH ? optarg : NULL;
+
+    // el cliente no carga la base de datos, le pide el comando al servidor
+    if(option == OPTION_CLIENT){
+        return run_client(argc, argv);
+    }
     
     // si no se llama a ayuda o hay error, se inician las estructuras de datos
     if(option > 0 && option != 2){
+        // mientras el servidor tiene la base de datos cargada, solo él la modifica
+        if(lock_database(option == OPTION_SERVE) != 0){
+            if(option == OPTION_SERVE){
+                printf("ERROR: La base de datos está en uso por otro proceso. Espere a que termine para iniciar el servidor.\n");
+            }
+            else{
+                printf("ERROR: El servidor está en ejecución. Envíele el comando con './devgraph --client <comando>'.\n");
+            }
+            return EXIT_FAILURE;
+        }
         table = create_hash_table();
         graph = initialize_graph();
         globalInterestsTable = init_global_interests();
         // cargar base de datos si es que existe
         if (database_exists_and_not_empty() && option != 3) {
-            load_database(table, graph, globalInterestsTable);
+            // los comandos de uno o dos usuarios cargan solo los usuarios que buscan
+            if(option==1||option==5||option==6||option==7||option==9||option==10||option==13||option==17||option==18){
+                open_database(table, graph, globalInterestsTable);
+            }
+            // borrar la base de datos no necesita cargarla
+            else if(option!=12){
+                load_database(table, graph, globalInterestsTable);
+            }
         }
         else {
             if(option==3){
@@ -72,117 +98,34 @@ int main(int argc, char *argv[]){
         }
     }
 
-    // verificación para comandos que requieren una sesión iniciada
-    if(option==5||option==6||option==9||option==10||option==11||option==13||option==14||option==15||option==17||option==18){
-        currentUser = current_session(table);
-        if(!currentUser){
-            printf("ERROR: No se ha iniciado sesión. Ejecute './devgraph -l' para iniciar sesión.\n");
-            free_structures_and_exit(table, graph, globalInterestsTable);
-        }
+    // un comando o lote fallido termina con código de error, después de guardar y liberar lo cargado
+    int status = COMMAND_OK;
+    if(option == OPTION_SERVE){
+        run_server(table, graph, globalInterestsTable);
     }
-
-    /* COMANDOS DEL PROGRAMA */
-    switch (option){
-
-    case 1: /* INICIO DE SESIÓN */
-        login(table);
-        break;
-
-    case 2: /* CIERRA SESIÓN */
-        logout();
-        break;
-    
-    case 4: /* REGISTRAR USUARIO */
-        register_user(table, graph, globalInterestsTable);
-        break;
-
-    case 5: /* PUBLICAR PUBLICACIÓN */
-        write_post(currentUser, globalInterestsTable);
-        break;
-
-    case 6: /* VER PERFIL DEL USUARIO */
-        print_user(currentUser, globalInterestsTable);
-        break;
-
-    case 7: {/* VER USUARIO */
-        User user = search_user(argv[2], table);
-        if(!user){
-            printf("ERROR: Usuario no encontrado\n");
-            return 0;
+    else if(option == OPTION_BATCH){
+        status = run_batch(batchFile, table, graph, globalInterestsTable);
+    }
+    else if(option > 0 && option != 3){
+        status = run_command(option, argc, argv, table, graph, globalInterestsTable, NULL);
+        if(status == COMMAND_NO_SESSION){
+            free_structures_and_exit(table, graph, globalInterestsTable);
         }
-        print_logo();
-        print_user(user, globalInterestsTable);
-        break;
     }
-    case 8: /* VER TODOS LOS USUARIOS */
-        print_logo();
-        print_all_users(graph);
-        break;
-    
-    case 9: /* SEGUIR A UN USUARIO */
-        follow(currentUser, argv[2], globalInterestsTable, table);
-        break;
-    
-    case 10: /* DEJAR DE SEGUIR A UN USUARIO */
-        unfollow(currentUser, argv[2], globalInterestsTable, table);
-        break;
-    
-    case 11: /* BORRAR CUENTA */
-        delete_account(currentUser);
-        break;
-
-    case 12: /* BORRAR BASE DE DATOS */
-        printf("Preparando, por favor espere...\n");
-        remove("current.dat");
-        clear_database(graph);
-        break;
-    
-    case 13: /* EDITAR INFORMACIÓN DEL USUARIO */
-        print_logo();
-        edit_account(currentUser, globalInterestsTable, table);
-        break;
-    
-    case 14: /* MOSTRAR POSTS */
-        search_posts_in_my_follows(&feed, currentUser);
-        search_posts_by_interests(&feed, table, globalInterestsTable, currentUser);
-        watch_posts(&feed);
-        free_heap(&feed);
-        break;
-    
-    case 15: /* MOSTRAR USUARIOS RECOMENDADOS*/
-        print_logo();
-        dijkstra(&feed, graph, currentUser);
-        watch_suggestions_friends_of_friends(&feed);
-        search_new_possible_friends(&feed, table, globalInterestsTable, currentUser);
-        watch_suggestions_by_interests(&feed);
-        free_heap(&feed);
-        break;
-    
-    case 16: /* MOSTRAR TEMAS */
-        printf("Tópicos de DevGraph:\n");
-        print_global_interests(globalInterestsTable);
-        break;
-    
-    case 17: /* MOSTRAR SEGUIDORES DEL USUARIO */
-        print_followers(currentUser);
-        break;
-    
-    case 18: /* MOSTRAR SEGUIDOS DEL USUARIO */
-        print_following(currentUser);
-        break;
-
-    default:
+    else{
         return 0;
-        break;
     }
 
     // LIBERAR MEMORIA
     if(option > 0 && option != 2){
+        flush_database(graph, globalInterestsTable);
         free_all_users(table, graph);
+        close_database();
         free_graph(graph);
         free_global_interests(globalInterestsTable);
         free_hash_table(table);
+        release_all_memory();
     }
 
-    return 0;
+    return status == COMMAND_OK ? 0 : EXIT_FAILURE;
 }
@@ -0,0 +1,228 @@
+/**
+ * @file ranking.c
+ * @brief Puntaje de las publicaciones del feed a partir de varias señales: recencia, afinidad, popularidad y seguidores del autor
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#include "ranking.h"
+#include "heaps.h"
+
+/**
+ * @brief Pesos por defecto del puntaje del feed
+ *
+ * @return FeedWeights
+ */
+FeedWeights default_feed_weights(void){
+    FeedWeights weights;
+    weights.recency = 1.0;
+    weights.affinity = 1.0;
+    weights.popularity = 0.5;
+    weights.followers = 0.5;
+    weights.following = 1.0;
+    weights.halfLifeHours = FEED_HALF_LIFE_HOURS;
+    return weights;
+}
+
+/**
+ * @brief Lee los pesos del puntaje del feed de un archivo
+ *
+ * @param path Archivo con una línea '<señal> <valor>' por peso (@see FEED_WEIGHTS_FILE)
+ * @return FeedWeights Pesos leídos; los que faltan, o todos si el archivo no existe, tienen su valor por defecto
+ *
+ * @note Las líneas vacías o que empiezan con '#' se ignoran
+ */
+FeedWeights load_feed_weights(const char *path){
+    FeedWeights weights = default_feed_weights();
+    FILE *fp = fopen(path, "r");
+    if (!fp) return weights;
+
+    char line[256], name[64];
+    double value;
+    while (fgets(line, sizeof(line), fp)) {
+        size_t skip = strspn(line, " \t");
+        if (line[skip] == '\0' || line[skip] == '\n' || line[skip] == '#') continue;
+        if (sscanf(line + skip, "%63s %lf", name, &value) != 2) {
+            printf("ERROR: Línea inválida en '%s': %s", path, line + skip);
+            continue;
+        }
+        if (strcmp(name, "recencia") == 0) weights.recency = value;
+        else if (strcmp(name, "afinidad") == 0) weights.affinity = value;
+        else if (strcmp(name, "popularidad") == 0) weights.popularity = value;
+        else if (strcmp(name, "seguidores") == 0) weights.followers = value;
+        else if (strcmp(name, "seguido") == 0) weights.following = value;
+        else if (strcmp(name, "vida_media") == 0 && value > 0) weights.halfLifeHours = value;
+        else printf("ERROR: Peso '%s' inválido en '%s'\n", name, path);
+    }
+    fclose(fp);
+    return weights;
+}
+
+/**
+ * @brief Convierte una fecha en segundos desde 1970, sin considerar la zona horaria
+ *
+ * @param date Fecha (solo se usan año, mes, día, hora, minuto y segundo)
+ * @return long long Segundos
+ *
+ * @note La fecha actual se convierte igual, así la diferencia entre ambas no depende de la zona horaria y no se llama a
+ *       mktime por cada publicación
+ */
+static long long date_seconds(const struct tm *date){
+    long long year = date->tm_year + 1900LL;
+    int month = date->tm_mon + 1;
+    if (month <= 2) year--;
+    long long era = (year >= 0 ? year : year - 399) / 400;
+    long long yearOfEra = year - era * 400;
+    long long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + date->tm_mday - 1;
+    long long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    long long days = era * 146097 + dayOfEra - 719468;
+    return days * 86400 + date->tm_hour * 3600LL + date->tm_min * 60LL + date->tm_sec;
+}
+
+/**
+ * @brief Combina las señales de una publicación en su puntaje
+ *
+ * @param weights Pesos de cada señal
+ * @param recency Recencia ya normalizada entre 0 y 1
+ * @param distance Distancia de jaccard entre el usuario y el autor
+ * @param popularity Popularidad del autor
+ * @param followers Cantidad de seguidores del autor
+ * @param followed 1 si el usuario sigue al autor, 0 si no
+ * @return double Puntaje
+ *
+ * @note La afinidad es 1 - distancia y la popularidad y los seguidores se normalizan como x / (x + escala); el puntaje es
+ *       la suma ponderada de las señales normalizadas
+ */
+static inline double feed_score(FeedWeights weights, double recency, double distance, double popularity, double followers, double followed){
+    return weights.recency * recency
+         + weights.affinity * (1 - distance)
+         + weights.popularity * (popularity / (popularity + FEED_POPULARITY_SCALE))
+         + weights.followers * (followers / (followers + FEED_FOLLOWERS_SCALE))
+         + weights.following * followed;
+}
+
+/**
+ * @brief Inicializa un bloque vacío de candidatos del feed
+ *
+ * @param candidates Candidatos
+ * @param feed Acumulador que recibe las publicaciones puntuadas (@see flush_feed_candidates)
+ * @param weights Pesos de cada señal
+ */
+void init_feed_candidates(FeedCandidates *candidates, TopK *feed, FeedWeights weights){
+    memset(candidates, 0, sizeof(FeedCandidates));
+    candidates->authors = (User *)malloc(FEED_SCORE_BLOCK * sizeof(User));
+    candidates->posts = (PtrToPostNode *)malloc(FEED_SCORE_BLOCK * sizeof(PtrToPostNode));
+    double **signals[] = {&candidates->ageHours, &candidates->distance, &candidates->popularity,
+                          &candidates->followers, &candidates->followed, &candidates->scores};
+    int error = !candidates->authors || !candidates->posts;
+    for (size_t i = 0; i < sizeof(signals) / sizeof(signals[0]); i++) {
+        *signals[i] = (double *)malloc(FEED_SCORE_BLOCK * sizeof(double));
+        if (!*signals[i]) error = 1;
+    }
+    if (error) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    candidates->feed = feed;
+    candidates->weights = weights;
+    time_t t = time(NULL);
+    struct tm now;
+    localtime_r(&t, &now);
+    candidates->now = date_seconds(&now);
+}
+
+/**
+ * @brief Añade todas las publicaciones de un autor como candidatas
+ *
+ * @param candidates Candidatos
+ * @param author Autor
+ * @param distance Distancia de jaccard entre el usuario y el autor (por ejemplo el peso de la arista si lo sigue)
+ * @param followed 1 si el usuario sigue al autor
+ *
+ * @note Las señales del autor se copian en cada publicación para que el puntaje se calcule sobre arreglos contiguos. Si ni
+ *       una publicación recién hecha del autor entraría en el feed, sus publicaciones se descartan sin copiarlas
+ */
+void add_author_posts(FeedCandidates *candidates, User author, double distance, int followed){
+    if (!(distance >= 0 && distance <= 1)) distance = 1; // sin intereses la distancia no está definida
+    double popularity = author->popularity;
+    double followers = author->numFollowers;
+    double followedSignal = followed ? 1.0 : 0.0;
+    // la recencia está entre 0 y 1, así que la cota usa el extremo que más suma según el signo de su peso
+    double bound = feed_score(candidates->weights, candidates->weights.recency >= 0 ? 1 : 0, distance, popularity, followers, followedSignal);
+    if (!top_k_accepts(candidates->feed, bound)) return;
+
+    for (PtrToPostNode postAux = author->posts->next; postAux; postAux = postAux->next) {
+        if (candidates->size == FEED_SCORE_BLOCK) {
+            flush_feed_candidates(candidates);
+            if (!top_k_accepts(candidates->feed, bound)) return;
+        }
+        int i = candidates->size++;
+        candidates->authors[i] = author;
+        candidates->posts[i] = postAux;
+        candidates->ageHours[i] = (candidates->now - date_seconds(&postAux->date)) / 3600.0;
+        candidates->distance[i] = distance;
+        candidates->popularity[i] = popularity;
+        candidates->followers[i] = followers;
+        candidates->followed[i] = followedSignal;
+    }
+}
+
+/**
+ * @brief Calcula el puntaje de los candidatos del bloque
+ *
+ * @param candidates Candidatos
+ *
+ * @note La recencia se normaliza como vida_media / (vida_media + edad). El recorrido no tiene saltos ni llamadas, así se
+ *       vectoriza con -O3
+ */
+static void score_feed_candidates(FeedCandidates *candidates){
+    const double *restrict ageHours = candidates->ageHours;
+    const double *restrict distance = candidates->distance;
+    const double *restrict popularity = candidates->popularity;
+    const double *restrict followers = candidates->followers;
+    const double *restrict followed = candidates->followed;
+    double *restrict scores = candidates->scores;
+    const FeedWeights weights = candidates->weights;
+    const double halfLife = weights.halfLifeHours;
+    for (int i = 0; i < candidates->size; i++) {
+        double age = ageHours[i] > 0 ? ageHours[i] : 0; // publicaciones con fecha futura cuentan como recién publicadas
+        scores[i] = feed_score(weights, halfLife / (halfLife + age), distance[i], popularity[i], followers[i], followed[i]);
+    }
+}
+
+/**
+ * @brief Puntúa los candidatos del bloque y guarda en el feed los que estén entre los mejores
+ *
+ * @param candidates Candidatos (el bloque queda vacío)
+ *
+ * @note Se llama sola cuando el bloque se llena; al terminar de añadir candidatos hay que llamarla para el último bloque
+ */
+void flush_feed_candidates(FeedCandidates *candidates){
+    score_feed_candidates(candidates);
+    for (int i = 0; i < candidates->size; i++) {
+        top_k_insert(candidates->feed, candidates->authors[i], candidates->posts[i], candidates->scores[i]);
+    }
+    candidates->size = 0;
+}
+
+/**
+ * @brief Libera los arreglos de candidatos
+ *
+ * @param candidates Candidatos (quedan vacíos; los que no se pasaron al feed se descartan)
+ */
+void free_feed_candidates(FeedCandidates *candidates){
+    free(candidates->authors);
+    free(candidates->posts);
+    free(candidates->ageHours);
+    free(candidates->distance);
+    free(candidates->popularity);
+    free(candidates->followers);
+    free(candidates->followed);
+    free(candidates->scores);
+    memset(candidates, 0, sizeof(FeedCandidates));
+}
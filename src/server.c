@@ -0,0 +1,352 @@
+/**
+ * @file server.c
+ * @brief Servidor que mantiene la base de datos cargada y atiende comandos por un socket Unix, y el cliente que se los envía
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#include "server.h"
+
+static volatile sig_atomic_t stopServer = 0; /* 1 al recibir SIGINT o SIGTERM */
+static Graph serverGraph = NULL; /* grafo del servidor en ejecución, @see save_server_at_exit */
+static GlobalInterests serverGlobalInterests; /* intereses globales del servidor en ejecución */
+
+/**
+ * @brief Guarda los cambios pendientes si el servidor termina con exit (por ejemplo sin memoria) en vez de con una señal
+ */
+static void save_server_at_exit(void){
+    if (!serverGraph) return;
+    flush_database(serverGraph, serverGlobalInterests);
+}
+
+/**
+ * @brief Manejador de SIGINT y SIGTERM: pide detener el servidor
+ *
+ * @param signalNumber Señal recibida
+ */
+static void handle_stop_signal(int signalNumber){
+    (void)signalNumber;
+    stopServer = 1;
+}
+
+/**
+ * @brief Milisegundos de un reloj monótono
+ *
+ * @return long long Milisegundos
+ */
+static long long monotonic_ms(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Lee exactamente una cantidad de bytes de un socket
+ *
+ * @param fd Socket
+ * @param buffer Destino
+ * @param length Cantidad de bytes
+ * @param deadline Instante (@see monotonic_ms) hasta el que se espera, o -1 para esperar sin límite
+ * @return int 0 si se leyeron todos, -1 si se cerró la conexión, hubo un error o se cumplió el plazo
+ */
+static int read_full(int fd, void *buffer, size_t length, long long deadline){
+    char *position = (char *)buffer;
+    while (length > 0) {
+        if (deadline >= 0) {
+            long long remaining = deadline - monotonic_ms();
+            if (remaining <= 0) return -1;
+            struct pollfd poller = {fd, POLLIN, 0};
+            int ready = poll(&poller, 1, (int)remaining);
+            if (ready < 0 && errno == EINTR && !stopServer) continue;
+            if (ready <= 0) return -1;
+        }
+        ssize_t readBytes = read(fd, position, length);
+        if (readBytes < 0 && errno == EINTR && !stopServer) continue;
+        if (readBytes <= 0) return -1;
+        position += readBytes;
+        length -= readBytes;
+    }
+    return 0;
+}
+
+/**
+ * @brief Escribe exactamente una cantidad de bytes en un socket
+ *
+ * @param fd Socket
+ * @param buffer Datos
+ * @param length Cantidad de bytes
+ * @return int 0 si se escribieron todos, -1 si hubo un error
+ */
+static int write_full(int fd, const void *buffer, size_t length){
+    const char *position = (const char *)buffer;
+    while (length > 0) {
+        ssize_t written = write(fd, position, length);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return -1;
+        position += written;
+        length -= written;
+    }
+    return 0;
+}
+
+/**
+ * @brief Atiende las solicitudes de una conexión hasta que el cliente la cierra
+ *
+ * @param fd Conexión
+ * @param table Tabla hash de usuarios
+ * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ * @return int Cantidad de solicitudes atendidas
+ *
+ * @note Cada solicitud debe llegar completa dentro de SERVER_REQUEST_TIMEOUT_MS y la respuesta se escribe con el mismo plazo;
+ *       si no, se cierra la conexión, así un cliente detenido no bloquea a los demás ni el guardado periódico
+ */
+static int serve_connection(int fd, PtrToHashTable table, Graph graph, GlobalInterests globalInterests){
+    int served = 0;
+    RequestHeader request;
+    struct timeval sendTimeout = {SERVER_REQUEST_TIMEOUT_MS / 1000, (SERVER_REQUEST_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+    long long deadline = monotonic_ms() + SERVER_REQUEST_TIMEOUT_MS;
+    while (!stopServer && read_full(fd, &request, sizeof(request), deadline) == 0) {
+        if (request.argc == 0 || request.argc > request.argsLength ||
+            (unsigned long long)request.argsLength + request.inputLength > SERVER_MAX_REQUEST) break;
+        char *data = (char *)malloc((size_t)request.argsLength + request.inputLength + 1);
+        char **argv = (char **)malloc((request.argc + 1) * sizeof(char *));
+        if (!data || !argv) {
+            printf("ERROR: No hay memoria suficiente\n");
+            exit(EXIT_FAILURE);
+        }
+        if (read_full(fd, data, (size_t)request.argsLength + request.inputLength, deadline) != 0) {
+            free(data);
+            free(argv);
+            break;
+        }
+
+        /* separar los argumentos, que deben terminar en '\0' dentro de argsLength */
+        unsigned int argc = 0, position = 0;
+        while (argc < request.argc && position < request.argsLength) {
+            argv[argc++] = data + position;
+            const char *terminator = memchr(data + position, '\0', request.argsLength - position);
+            if (!terminator) break;
+            position = terminator - data + 1;
+        }
+        if (argc != request.argc || position != request.argsLength) {
+            free(data);
+            free(argv);
+            break;
+        }
+        argv[argc] = NULL;
+
+        char *output = NULL;
+        size_t outputLength = 0;
+        ResponseHeader response;
+        response.status = run_command_captured(argc, argv, NULL, data + request.argsLength, request.inputLength, &output, &outputLength,
+                                               table, graph, globalInterests);
+        /* un cambio confirmado al cliente ya está en disco; sin cambios pendientes no se escribe nada */
+        if (write_wal() != 0) response.status = COMMAND_ERROR;
+        response.outputLength = outputLength;
+        int error = write_full(fd, &response, sizeof(response)) != 0 || write_full(fd, output, outputLength) != 0;
+        free(output);
+        free(data);
+        free(argv);
+        served++;
+        if (error) break;
+        deadline = monotonic_ms() + SERVER_REQUEST_TIMEOUT_MS;
+    }
+    return served;
+}
+
+/**
+ * @brief Mantiene la base de datos cargada y atiende comandos por SERVER_SOCKET_FILE hasta recibir SIGINT o SIGTERM
+ *
+ * @param table Tabla hash de usuarios
+ * @param graph Grafo de usuarios (ya cargado)
+ * @param globalInterests Tabla de intereses globales
+ *
+ * @note Las conexiones se atienden de a una, ya que el grafo no se puede modificar desde varios hilos. Los registros del WAL de
+ *       cada comando se escriben antes de responderle al cliente (@see write_wal); el resto de @see flush_database (incorporar
+ *       el WAL al snapshot) se hace cuando el servidor queda sin solicitudes o a más tardar cada SERVER_FLUSH_INTERVAL_MS. Si
+ *       el programa termina con exit los cambios pendientes se guardan igual (@see save_server_at_exit)
+ * @note Se llama con el lock exclusivo de la base de datos ya tomado antes de cargarla (@see lock_database), y se mantiene hasta
+ *       que termina el programa: mientras tanto los comandos directos no la abren y deben pasar por '--client'
+ */
+void run_server(PtrToHashTable table, Graph graph, GlobalInterests globalInterests){
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, SERVER_SOCKET_FILE, sizeof(address.sun_path) - 1);
+    unlink(SERVER_SOCKET_FILE);
+    if (listener == -1 || bind(listener, (struct sockaddr *)&address, sizeof(address)) == -1 || listen(listener, 16) == -1) {
+        printf("ERROR: No se pudo abrir el socket '%s'\n", SERVER_SOCKET_FILE);
+        if (listener != -1) close(listener);
+        return;
+    }
+
+    /* al terminar solo se borra el socket si sigue siendo el de este servidor */
+    struct stat socketInfo;
+    ino_t socketInode = stat(SERVER_SOCKET_FILE, &socketInfo) == 0 ? socketInfo.st_ino : 0;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_stop_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    serverGraph = graph;
+    serverGlobalInterests = globalInterests;
+    atexit(save_server_at_exit);
+
+    printf("Servidor de DevGraph escuchando en '%s' con %d usuarios cargados. Detener con Ctrl+C.\n", SERVER_SOCKET_FILE, graph->usersNumber);
+    fflush(stdout);
+
+    long long served = 0;
+    int pendingChanges = 0;
+    long long lastFlush = monotonic_ms();
+    while (!stopServer) {
+        int timeout = -1;
+        if (pendingChanges) {
+            long long remaining = lastFlush + SERVER_FLUSH_INTERVAL_MS - monotonic_ms();
+            timeout = remaining > 0 ? (int)remaining : 0;
+        }
+        struct pollfd poller = {listener, POLLIN, 0};
+        int ready = poll(&poller, 1, timeout);
+        if (ready < 0 && errno != EINTR) break;
+
+        if (ready > 0) {
+            int client = accept(listener, NULL, NULL);
+            if (client >= 0) {
+                int requests = serve_connection(client, table, graph, globalInterests);
+                close(client);
+                served += requests;
+                pendingChanges |= requests > 0;
+            }
+        }
+        if (pendingChanges && (ready == 0 || monotonic_ms() - lastFlush >= SERVER_FLUSH_INTERVAL_MS)) {
+            flush_database(graph, globalInterests);
+            pendingChanges = 0;
+            lastFlush = monotonic_ms();
+        }
+    }
+
+    flush_database(graph, globalInterests);
+    serverGraph = NULL;
+    close(listener);
+    if (stat(SERVER_SOCKET_FILE, &socketInfo) == 0 && socketInfo.st_ino == socketInode) unlink(SERVER_SOCKET_FILE);
+    printf("Servidor detenido después de %lld solicitudes.\n", served);
+}
+
+/**
+ * @brief Envía un comando al servidor e imprime su salida
+ *
+ * @param argc Número de argumentos
+ * @param argv Argumentos ingresados al programa (argv[1] es '--client', el comando va después)
+ * @return int Código de salida: 0 si el comando terminó bien
+ *
+ * @note En los comandos que leen datos (@see command_reads_input), si la entrada estándar no es una terminal se envía
+ *       completa como entrada del comando, por ejemplo printf "usuario\ncontraseña\n" | ./devgraph.out --client -l
+ */
+int run_client(int argc, char *argv[]){
+    if (argc < 3) {
+        printf("ERROR: Falta el comando. Ejemplo: './devgraph --client -m'\n");
+        return EXIT_FAILURE;
+    }
+
+    /* argumentos: nombre del programa y luego el comando, sin '--client' */
+    char **commandArgv = (char **)malloc(argc * sizeof(char *));
+    if (!commandArgv) {
+        printf("ERROR: No hay memoria suficiente\n");
+        return EXIT_FAILURE;
+    }
+    commandArgv[0] = argv[0];
+    for (int i = 2; i < argc; i++) commandArgv[i - 1] = argv[i];
+    commandArgv[argc - 1] = NULL;
+    optind = 0;
+    int option = get_option(argc - 1, commandArgv);
+    free(commandArgv);
+    if (option <= 0) return option == 0 ? 0 : EXIT_FAILURE; /* la ayuda se muestra sin el servidor */
+
+    size_t argsLength = strlen(argv[0]) + 1;
+    for (int i = 2; i < argc; i++) argsLength += strlen(argv[i]) + 1;
+    size_t inputLength = 0, inputCapacity = 4096;
+    char *data = (char *)malloc(argsLength + inputCapacity);
+    if (!data) {
+        printf("ERROR: No hay memoria suficiente\n");
+        return EXIT_FAILURE;
+    }
+    size_t position = 0;
+    for (int i = 0; i < argc; i++) {
+        if (i == 1) continue;
+        size_t length = strlen(argv[i]) + 1;
+        memcpy(data + position, argv[i], length);
+        position += length;
+    }
+
+    if (command_reads_input(option) && !isatty(STDIN_FILENO)) {
+        ssize_t readBytes;
+        while (1) {
+            if (inputLength == inputCapacity) {
+                inputCapacity *= 2;
+                char *grown = (char *)realloc(data, argsLength + inputCapacity);
+                if (!grown) {
+                    printf("ERROR: No hay memoria suficiente\n");
+                    free(data);
+                    return EXIT_FAILURE;
+                }
+                data = grown;
+            }
+            readBytes = read(STDIN_FILENO, data + argsLength + inputLength, inputCapacity - inputLength);
+            if (readBytes <= 0) break;
+            inputLength += readBytes;
+        }
+    }
+    if (argsLength + inputLength > SERVER_MAX_REQUEST) {
+        printf("ERROR: La entrada es demasiado grande\n");
+        free(data);
+        return EXIT_FAILURE;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, SERVER_SOCKET_FILE, sizeof(address.sun_path) - 1);
+    if (fd == -1 || connect(fd, (struct sockaddr *)&address, sizeof(address)) == -1) {
+        printf("ERROR: No se pudo conectar al servidor. Ejecute './devgraph --serve' en este directorio.\n");
+        if (fd != -1) close(fd);
+        free(data);
+        return EXIT_FAILURE;
+    }
+
+    RequestHeader request;
+    request.argc = argc - 1;
+    request.argsLength = argsLength;
+    request.inputLength = inputLength;
+    ResponseHeader response;
+    int error = write_full(fd, &request, sizeof(request)) != 0 || write_full(fd, data, argsLength + inputLength) != 0 ||
+                read_full(fd, &response, sizeof(response), -1) != 0;
+    free(data);
+    if (error) {
+        printf("ERROR: Se perdió la conexión con el servidor\n");
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    char buffer[4096];
+    size_t remaining = response.outputLength;
+    while (remaining > 0) {
+        size_t chunk = remaining < sizeof(buffer) ? remaining : sizeof(buffer);
+        if (read_full(fd, buffer, chunk, -1) != 0) break;
+        fwrite(buffer, 1, chunk, stdout);
+        remaining -= chunk;
+    }
+    close(fd);
+    return response.status == COMMAND_OK ? 0 : EXIT_FAILURE;
+}
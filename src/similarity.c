@@ -0,0 +1,719 @@
+/**
+ * @file similarity.c
+ * @brief Búsqueda aproximada de usuarios con intereses similares (MinHash y LSH)
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#include "similarity.h"
+
+/**
+ * @brief Mezcla los bits de un entero de 32 bits con una semilla
+ *
+ * @param x Valor a mezclar
+ * @param seed Semilla de la función hash
+ * @return unsigned int
+ */
+static unsigned int mix_hash(unsigned int x, unsigned int seed){
+    x ^= seed;
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * @brief Semilla de la i-ésima función hash de MinHash
+ *
+ * @param i Índice de la función hash
+ * @return unsigned int
+ */
+static unsigned int minhash_seed(int i){
+    return mix_hash((unsigned int)i + 1, 0x9e3779b9U);
+}
+
+/**
+ * @brief Calcula la firma MinHash de un conjunto de intereses
+ *
+ * @param interests Conjunto de bits de intereses
+ * @param globalInterests Tabla de intereses globales
+ * @param signature Arreglo de MINHASH_NUM_HASHES valores donde se guarda la firma
+ *
+ * @note La probabilidad de que dos firmas coincidan en una posición es la similitud de jaccard de los conjuntos
+ */
+void minhash_signature(InterestTable interests, GlobalInterests globalInterests, unsigned int *signature){
+    for (int i = 0; i < MINHASH_NUM_HASHES; i++){
+        signature[i] = 0xffffffffU;
+    }
+    for (int w = 0; w < globalInterests.numWords; w++){
+        InterestWord word = interests[w];
+        while (word){
+            unsigned int interestId = w * INTEREST_WORD_BITS + __builtin_ctzll(word);
+            word &= word - 1;
+            for (int i = 0; i < MINHASH_NUM_HASHES; i++){
+                unsigned int value = mix_hash(interestId, minhash_seed(i));
+                if (value < signature[i]) signature[i] = value;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Calcula el hash de una banda de una firma MinHash
+ *
+ * @param signature Firma MinHash
+ * @param band Índice de la banda
+ * @return unsigned long long
+ */
+static unsigned long long band_key(const unsigned int *signature, int band){
+    unsigned long long key = 1469598103934665603ULL ^ (unsigned long long)band;
+    for (int r = 0; r < LSH_ROWS; r++){
+        key ^= signature[band * LSH_ROWS + r];
+        key *= 1099511628211ULL;
+    }
+    return key;
+}
+
+/**
+ * @brief Compara entradas de LSH por hash de banda
+ */
+static int compare_lsh_entries(const void *a, const void *b){
+    const LshEntry *e1 = (const LshEntry *)a;
+    const LshEntry *e2 = (const LshEntry *)b;
+    if (e1->key != e2->key) return e1->key < e2->key ? -1 : 1;
+    return e1->userId - e2->userId;
+}
+
+/**
+ * @brief Indica si un usuario no tiene intereses
+ *
+ * @param user Usuario
+ * @param globalInterests Tabla de intereses globales
+ * @return int 1 si no tiene intereses
+ */
+static int has_no_interests(User user, GlobalInterests globalInterests){
+    for (int w = 0; w < globalInterests.numWords; w++){
+        if (user->interests[w]) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Construye las firmas MinHash y los buckets de LSH de todos los usuarios
+ *
+ * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ * @return LshIndex Índice LSH, liberar con @see free_lsh_index
+ *
+ * @note Los usuarios sin intereses no se agregan a los buckets
+ */
+LshIndex build_lsh_index(Graph graph, GlobalInterests globalInterests){
+    LshIndex lsh = (LshIndex)malloc(sizeof(struct _lshIndex));
+    if (!lsh){
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    lsh->numNodes = graph->nextId;
+    lsh->bandSize = 0;
+    lsh->numWords = globalInterests.numWords;
+    lsh->graph = graph;
+    lsh->interestsVersion = graph->interestsVersion;
+    /* calloc: las filas de los usuarios sin intereses no se calculan */
+    lsh->signatures = (unsigned int *)calloc(((size_t)lsh->numNodes + 1) * MINHASH_NUM_HASHES, sizeof(unsigned int));
+    for (int b = 0; b < LSH_BANDS; b++){
+        lsh->bands[b] = (LshEntry *)malloc(((size_t)graph->usersNumber + 1) * sizeof(LshEntry));
+        if (!lsh->bands[b]){
+            printf("ERROR: No hay memoria suficiente\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (!lsh->signatures){
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int id = 0; id < lsh->numNodes; id++){
+        User user = graph->usersById[id];
+        if (!user || has_no_interests(user, globalInterests)) continue;
+        unsigned int *signature = &lsh->signatures[(size_t)id * MINHASH_NUM_HASHES];
+        minhash_signature(user->interests, globalInterests, signature);
+        for (int b = 0; b < LSH_BANDS; b++){
+            lsh->bands[b][lsh->bandSize].key = band_key(signature, b);
+            lsh->bands[b][lsh->bandSize].userId = id;
+        }
+        lsh->bandSize++;
+    }
+
+    for (int b = 0; b < LSH_BANDS; b++){
+        qsort(lsh->bands[b], lsh->bandSize, sizeof(LshEntry), compare_lsh_entries);
+    }
+    return lsh;
+}
+
+/**
+ * @brief Obtiene el índice LSH del grafo, construyéndolo solo si no existe o si cambiaron los intereses desde la última vez
+ *
+ * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ * @return LshIndex Índice LSH, no se libera (se reutiliza en las siguientes búsquedas)
+ *
+ * @note Con el servidor o un lote de comandos (@see run_server, @see run_batch) el índice se construye una vez y solo se
+ *       reconstruye cuando cambia el índice de intereses del grafo (@see interestsVersion)
+ */
+LshIndex cached_lsh_index(Graph graph, GlobalInterests globalInterests){
+    static LshIndex cached = NULL;
+    if (cached && cached->graph == graph && cached->interestsVersion == graph->interestsVersion &&
+        cached->numWords == globalInterests.numWords){
+        return cached;
+    }
+    free_lsh_index(cached);
+    cached = build_lsh_index(graph, globalInterests);
+    return cached;
+}
+
+/**
+ * @brief Libera un índice LSH
+ *
+ * @param lsh Índice LSH
+ */
+void free_lsh_index(LshIndex lsh){
+    if (!lsh) return;
+    for (int b = 0; b < LSH_BANDS; b++){
+        free(lsh->bands[b]);
+    }
+    free(lsh->signatures);
+    free(lsh);
+}
+
+/**
+ * @brief Obtiene los usuarios que comparten al menos una banda de LSH con un usuario
+ *
+ * @param lsh Índice LSH
+ * @param graph Grafo de usuarios
+ * @param user Usuario de referencia (no se incluye en el resultado)
+ * @param candidates Arreglo de ids candidatos (liberar con free)
+ * @return int Cantidad de candidatos
+ *
+ * @note Los candidatos son aproximados: hay que verificarlos con @see edge_jaccard
+ */
+int lsh_candidates(LshIndex lsh, Graph graph, User user, int **candidates){
+    *candidates = NULL;
+    if (user->id < 0 || user->id >= lsh->numNodes || graph->usersById[user->id] != user) return 0;
+    /* un usuario sin intereses no tiene firma (@see build_lsh_index) */
+    int hasInterests = 0;
+    for (int w = 0; w < lsh->numWords && !hasInterests; w++) hasInterests = user->interests[w] != 0;
+    if (!hasInterests) return 0;
+
+    char *seen = (char *)calloc(lsh->numNodes + 1, sizeof(char));
+    int count = 0, capacity = 0;
+    if (!seen){
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    const unsigned int *signature = &lsh->signatures[(size_t)user->id * MINHASH_NUM_HASHES];
+
+    for (int b = 0; b < LSH_BANDS; b++){
+        unsigned long long key = band_key(signature, b);
+        const LshEntry *band = lsh->bands[b];
+        int low = 0, high = lsh->bandSize;
+        while (low < high){
+            int middle = low + (high - low) / 2;
+            if (band[middle].key < key) low = middle + 1;
+            else high = middle;
+        }
+        for (int i = low; i < lsh->bandSize && band[i].key == key; i++){
+            int id = band[i].userId;
+            if (id == user->id || seen[id] || !graph->usersById[id]) continue;
+            seen[id] = 1;
+            if (count == capacity){
+                capacity = capacity ? capacity * 2 : 64;
+                int *newCandidates = (int *)realloc(*candidates, capacity * sizeof(int));
+                if (!newCandidates){
+                    printf("ERROR: No hay memoria suficiente\n");
+                    exit(EXIT_FAILURE);
+                }
+                *candidates = newCandidates;
+            }
+            (*candidates)[count++] = id;
+        }
+    }
+    free(seen);
+    return count;
+}
+
+/**
+ * @brief Mide el recall de la búsqueda aproximada con LSH contra la búsqueda exacta con @see edge_jaccard
+ *
+ * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ *
+ * @note Un usuario es similar si su distancia de jaccard es <= 0.5 (el mismo criterio de las sugerencias por intereses).
+ *       Se consultan hasta RECALL_MAX_USERS usuarios repartidos en toda la red.
+ */
+void measure_lsh_recall(Graph graph, GlobalInterests globalInterests){
+    clock_t start = clock();
+    LshIndex lsh = build_lsh_index(graph, globalInterests);
+    double buildTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    int step = graph->usersNumber / RECALL_MAX_USERS;
+    if (step < 1) step = 1;
+
+    long exactTotal = 0, foundTotal = 0, exactCandidates = 0, approxCandidates = 0;
+    double exactTime = 0, approxTime = 0;
+    int queries = 0, seenUsers = 0;
+
+    for (int id = 0; id < graph->nextId && queries < RECALL_MAX_USERS; id++){
+        User user = graph->usersById[id];
+        if (!user || has_no_interests(user, globalInterests)) continue;
+        if (seenUsers++ % step != 0) continue;
+        queries++;
+
+        /* búsqueda exacta sobre el índice invertido */
+        start = clock();
+        InterestCandidate *candidates;
+        int count = search_interest_candidates(graph, user, &candidates);
+        char *similar = (char *)calloc(graph->nextId + 1, sizeof(char));
+        for (int i = 0; i < count; i++){
+            if (edge_jaccard(user, graph->usersById[candidates[i].userId], globalInterests) <= 0.5){
+                similar[candidates[i].userId] = 1;
+                exactTotal++;
+            }
+        }
+        exactCandidates += count;
+        free(candidates);
+        exactTime += (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        /* búsqueda aproximada con LSH */
+        start = clock();
+        int *approx;
+        int approxCount = lsh_candidates(lsh, graph, user, &approx);
+        for (int i = 0; i < approxCount; i++){
+            if (edge_jaccard(user, graph->usersById[approx[i]], globalInterests) <= 0.5 && similar[approx[i]]){
+                foundTotal++;
+            }
+        }
+        approxCandidates += approxCount;
+        free(approx);
+        approxTime += (double)(clock() - start) / CLOCKS_PER_SEC;
+        free(similar);
+    }
+    free_lsh_index(lsh);
+
+    printf("RECALL DE LSH (%d hashes, %d bandas de %d filas)\n", MINHASH_NUM_HASHES, LSH_BANDS, LSH_ROWS);
+    printf("Usuarios consultados: %d de %d\n", queries, graph->usersNumber);
+    printf("Construcción del índice: %.3f s\n", buildTime);
+    if (queries == 0){
+        printf("No hay usuarios con intereses para medir.\n");
+        return;
+    }
+    printf("Similares exactos: %ld | encontrados por LSH: %ld\n", exactTotal, foundTotal);
+    printf("Recall: %.4f\n", exactTotal ? (double)foundTotal / exactTotal : 1.0);
+    printf("Candidatos promedio: exacto %.1f | LSH %.1f\n", (double)exactCandidates / queries, (double)approxCandidates / queries);
+    printf("Tiempo por consulta: exacto %.6f s | LSH %.6f s\n", exactTime / queries, approxTime / queries);
+}
+
+/**
+ * @struct _similarityPosting
+ * @brief Usuario de la lista de un interés en el cálculo de similitudes
+ */
+struct _similarityPosting{
+    int position; /*!< Posición del usuario en el orden por tamaño */
+    int rank; /*!< Posición del interés entre los del usuario, ordenados del menos al más frecuente */
+};
+
+/**
+ * @struct _similarityJob
+ * @brief Datos compartidos por los hilos del cálculo de similitudes
+ * @note Los usuarios están ordenados por cantidad de intereses y sus conjuntos de bits guardados de forma contigua en ese orden.
+ *       Los intereses de cada usuario se ordenan del menos al más frecuente (el mismo orden para todos), y cada interés tiene
+ *       la lista de usuarios que lo tienen, tomada del índice invertido del grafo
+ */
+struct _similarityJob{
+    int numUsers; /*!< Cantidad de usuarios con intereses */
+    int numWords; /*!< Palabras por conjunto de bits */
+    const int *userIds; /*!< Id de cada usuario en el orden por tamaño */
+    const int *sizes; /*!< Cantidad de intereses de cada usuario en el orden por tamaño */
+    const InterestWord *bits; /*!< Conjuntos de bits contiguos en el orden por tamaño */
+    const int *tokenOffsets; /*!< Inicio de los intereses de cada usuario en tokens (numUsers + 1 elementos) */
+    const int *tokens; /*!< Intereses de cada usuario, del menos al más frecuente */
+    const int *postingOffsets; /*!< Inicio de la lista de cada interés en postings (numInterests + 1 elementos) */
+    const struct _similarityPosting *postings; /*!< Usuarios de cada interés */
+    int *topIds; /*!< Resultado: SIMILARITY_TOP_K ids por id de usuario (-1 si no hay) */
+    float *topSimilarities; /*!< Resultado: similitud de cada id de topIds */
+    int nextUser; /*!< Siguiente posición a procesar (se reparte entre hilos) */
+    long comparisons; /*!< Cantidad de pares comparados */
+    long scanned; /*!< Cantidad de entradas de las listas de intereses recorridas */
+};
+
+/**
+ * @brief Compara pares (cantidad de intereses, id) por cantidad de intereses
+ */
+static int compare_by_size(const void *a, const void *b){
+    const int *p1 = (const int *)a;
+    const int *p2 = (const int *)b;
+    if (p1[0] != p2[0]) return p1[0] - p2[0];
+    return p1[1] - p2[1];
+}
+
+/**
+ * @brief Inserta un candidato en el top-k de un usuario (heap de mínimos por similitud)
+ *
+ * @param ids Ids del top-k
+ * @param similarities Similitudes del top-k
+ * @param size Cantidad de elementos en el top-k
+ * @param id Id del candidato
+ * @param similarity Similitud del candidato
+ */
+static void topk_push(int *ids, float *similarities, int *size, int id, float similarity){
+    int index;
+    if (*size < SIMILARITY_TOP_K){
+        index = (*size)++;
+        while (index > 0 && similarities[(index - 1) / 2] > similarity){
+            ids[index] = ids[(index - 1) / 2];
+            similarities[index] = similarities[(index - 1) / 2];
+            index = (index - 1) / 2;
+        }
+    }
+    else {
+        if (similarity <= similarities[0]) return;
+        index = 0;
+        while (1){
+            int child = 2 * index + 1;
+            if (child >= *size) break;
+            if (child + 1 < *size && similarities[child + 1] < similarities[child]) child++;
+            if (similarities[child] >= similarity) break;
+            ids[index] = ids[child];
+            similarities[index] = similarities[child];
+            index = child;
+        }
+    }
+    ids[index] = id;
+    similarities[index] = similarity;
+}
+
+/**
+ * @brief Calcula el top-k de similitud de un usuario con filtrado por prefijo sobre las listas de sus intereses
+ *
+ * @param job Datos compartidos
+ * @param position Posición del usuario en el orden por tamaño
+ * @param seen Marca por posición de los usuarios ya considerados (position + 1), propia del hilo
+ * @param scanned Se suman las entradas de las listas recorridas
+ * @return long Cantidad de pares comparados
+ *
+ * @note Un usuario B que no comparte ninguno de los primeros i intereses de A comparte a lo más |A| - i, así que su similitud es
+ *       a lo más (|A| - i) / |A|: cuando el top-k está lleno y esa cota no supera al k-ésimo, no se recorren más listas (como se
+ *       recorren primero los intereses menos frecuentes, las listas largas casi nunca se recorren). Además, si el primer interés
+ *       común es el i-ésimo de A y el j-ésimo de B, comparten a lo más min(|A| - i, |B| - j); si la similitud que eso permite no
+ *       supera al k-ésimo, B se descarta sin comparar sus bits. El resultado es exacto
+ */
+static long similarity_join_user(struct _similarityJob *job, int position, int *seen, long *scanned){
+    int ids[SIMILARITY_TOP_K];
+    float similarities[SIMILARITY_TOP_K];
+    int size = 0;
+    long comparisons = 0;
+    int words = job->numWords;
+    const InterestWord *a = &job->bits[(size_t)position * words];
+    int sizeA = job->sizes[position];
+    const int *tokensA = &job->tokens[job->tokenOffsets[position]];
+    seen[position] = position + 1;
+
+    for (int i = 0; i < sizeA; i++){
+        if (size == SIMILARITY_TOP_K && (double)(sizeA - i) / sizeA <= similarities[0]) break;
+        int interest = tokensA[i];
+        for (int e = job->postingOffsets[interest]; e < job->postingOffsets[interest + 1]; e++){
+            int other = job->postings[e].position;
+            if (seen[other] == position + 1) continue;
+            seen[other] = position + 1;
+            (*scanned)++;
+            int sizeB = job->sizes[other];
+            if (size == SIMILARITY_TOP_K){
+                int restA = sizeA - i, restB = sizeB - job->postings[e].rank;
+                int maxSame = restA < restB ? restA : restB;
+                if ((double)maxSame / (sizeA + sizeB - maxSame) <= similarities[0]) continue;
+            }
+
+            const InterestWord *b = &job->bits[(size_t)other * words];
+            int same = 0;
+            for (int w = 0; w < words; w++) same += __builtin_popcountll(a[w] & b[w]);
+            comparisons++;
+            topk_push(ids, similarities, &size, job->userIds[other], (float)same / (sizeA + sizeB - same));
+        }
+    }
+
+    /* ordenar de mayor a menor similitud y guardar */
+    int id = job->userIds[position];
+    int *outIds = &job->topIds[(size_t)id * SIMILARITY_TOP_K];
+    float *outSimilarities = &job->topSimilarities[(size_t)id * SIMILARITY_TOP_K];
+    for (int i = size - 1; i >= 0; i--){
+        outIds[i] = ids[0];
+        outSimilarities[i] = similarities[0];
+        ids[0] = ids[size - 1];
+        similarities[0] = similarities[size - 1];
+        size--;
+        int index = 0;
+        while (1){
+            int child = 2 * index + 1;
+            if (child >= size) break;
+            if (child + 1 < size && similarities[child + 1] < similarities[child]) child++;
+            if (similarities[child] >= similarities[index]) break;
+            int tempId = ids[index]; ids[index] = ids[child]; ids[child] = tempId;
+            float tempSimilarity = similarities[index]; similarities[index] = similarities[child]; similarities[child] = tempSimilarity;
+            index = child;
+        }
+    }
+    return comparisons;
+}
+
+/**
+ * @brief Hilo del cálculo de similitudes: toma bloques de usuarios hasta terminar
+ *
+ * @param arg Puntero a struct _similarityJob
+ * @return void* NULL
+ */
+static void *similarity_join_worker(void *arg){
+    struct _similarityJob *job = (struct _similarityJob *)arg;
+    const int block = 64;
+    long comparisons = 0, scanned = 0;
+    int *seen = (int *)calloc((size_t)job->numUsers + 1, sizeof(int));
+    if (!seen){
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    while (1){
+        int start = __atomic_fetch_add(&job->nextUser, block, __ATOMIC_RELAXED);
+        if (start >= job->numUsers) break;
+        int end = start + block < job->numUsers ? start + block : job->numUsers;
+        for (int position = start; position < end; position++){
+            comparisons += similarity_join_user(job, position, seen, &scanned);
+        }
+    }
+    free(seen);
+    __atomic_fetch_add(&job->comparisons, comparisons, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&job->scanned, scanned, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+/**
+ * @brief Precalcula con varios hilos los SIMILARITY_TOP_K usuarios con intereses más similares a cada usuario y los guarda en un archivo
+ *
+ * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ * @param path Archivo de salida
+ *
+ * @note Formato binario: "DGTOPK1" + '\0', k y cantidad de ids (int), y luego k pares (id int, similitud float) por cada id de usuario,
+ *       con id -1 en los lugares vacíos. Así la lectura de un usuario es un solo fseek (@see read_similar_users)
+ */
+void compute_similarity_join(Graph graph, GlobalInterests globalInterests, const char *path){
+    struct timespec startTime, endTime;
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    int numNodes = graph->nextId;
+    int words = globalInterests.numWords;
+    struct _similarityJob job;
+
+    /* ordenar usuarios con intereses por tamaño */
+    int *order = (int *)malloc(((size_t)graph->usersNumber + 1) * 2 * sizeof(int));
+    int numUsers = 0;
+    if (!order){
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int id = 0; id < numNodes; id++){
+        User user = graph->usersById[id];
+        if (!user) continue;
+        int size = 0;
+        for (int w = 0; w < words; w++) size += __builtin_popcountll(user->interests[w]);
+        if (size == 0) continue;
+        order[2 * numUsers] = size;
+        order[2 * numUsers + 1] = id;
+        numUsers++;
+    }
+    qsort(order, numUsers, 2 * sizeof(int), compare_by_size);
+
+    int *userIds = (int *)malloc(((size_t)numUsers + 1) * sizeof(int));
+    int *sizes = (int *)malloc(((size_t)numUsers + 1) * sizeof(int));
+    InterestWord *bits = (InterestWord *)malloc(((size_t)numUsers + 1) * words * sizeof(InterestWord));
+    job.topIds = (int *)malloc(((size_t)numNodes + 1) * SIMILARITY_TOP_K * sizeof(int));
+    job.topSimilarities = (float *)calloc(((size_t)numNodes + 1) * SIMILARITY_TOP_K, sizeof(float));
+    if (!userIds || !sizes || !bits || !job.topIds || !job.topSimilarities){
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < numUsers; i++){
+        sizes[i] = order[2 * i];
+        userIds[i] = order[2 * i + 1];
+        memcpy(&bits[(size_t)i * words], graph->usersById[userIds[i]]->interests, words * sizeof(InterestWord));
+    }
+    free(order);
+    memset(job.topIds, 0xff, (size_t)numNodes * SIMILARITY_TOP_K * sizeof(int));
+
+    /* intereses de cada usuario del menos al más frecuente, según las listas del índice invertido */
+    int numInterests = graph->numIndexedInterests;
+    int *frequencyOrder = (int *)malloc(((size_t)numInterests + 1) * 2 * sizeof(int));
+    int *positionOfId = (int *)malloc(((size_t)numNodes + 1) * sizeof(int));
+    int *tokenOffsets = (int *)malloc(((size_t)numUsers + 1) * sizeof(int));
+    int *postingOffsets = (int *)malloc(((size_t)numInterests + 1) * sizeof(int));
+    if (!frequencyOrder || !positionOfId || !tokenOffsets || !postingOffsets){
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < numInterests; i++){
+        frequencyOrder[2 * i] = graph->interestIndex[i].size;
+        frequencyOrder[2 * i + 1] = i;
+    }
+    qsort(frequencyOrder, numInterests, 2 * sizeof(int), compare_by_size);
+    memset(positionOfId, 0xff, (size_t)numNodes * sizeof(int));
+    tokenOffsets[0] = 0;
+    for (int i = 0; i < numUsers; i++){
+        positionOfId[userIds[i]] = i;
+        tokenOffsets[i + 1] = tokenOffsets[i] + sizes[i];
+    }
+    int *tokens = (int *)malloc(((size_t)tokenOffsets[numUsers] + 1) * sizeof(int));
+    struct _similarityPosting *postings = (struct _similarityPosting *)malloc(((size_t)tokenOffsets[numUsers] + 1) * sizeof(struct _similarityPosting));
+    if (!tokens || !postings){
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < numUsers; i++){
+        int *userTokens = &tokens[tokenOffsets[i]];
+        int count = 0;
+        for (int r = 0; r < numInterests && count < sizes[i]; r++){
+            int interest = frequencyOrder[2 * r + 1];
+            if (bits[(size_t)i * words + interest / 64] >> (interest % 64) & 1) userTokens[count++] = interest;
+        }
+    }
+    int filled = 0;
+    for (int i = 0; i < numInterests; i++){
+        postingOffsets[i] = filled;
+        InterestPostings *list = &graph->interestIndex[i];
+        for (int u = 0; u < list->size; u++){
+            int id = list->userIds[u];
+            int position = id < numNodes ? positionOfId[id] : -1;
+            if (position < 0) continue;
+            const int *userTokens = &tokens[tokenOffsets[position]];
+            int rank = 0;
+            while (rank < sizes[position] && userTokens[rank] != i) rank++;
+            if (rank == sizes[position]) continue;
+            postings[filled].position = position;
+            postings[filled].rank = rank;
+            filled++;
+        }
+    }
+    postingOffsets[numInterests] = filled;
+    free(frequencyOrder);
+    free(positionOfId);
+
+    job.numUsers = numUsers;
+    job.numWords = words;
+    job.userIds = userIds;
+    job.sizes = sizes;
+    job.bits = bits;
+    job.tokenOffsets = tokenOffsets;
+    job.tokens = tokens;
+    job.postingOffsets = postingOffsets;
+    job.postings = postings;
+    job.nextUser = 0;
+    job.comparisons = 0;
+    job.scanned = 0;
+
+    /* repartir el trabajo entre hilos */
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int numThreads = cores < 1 ? 1 : (cores > SIMILARITY_MAX_THREADS ? SIMILARITY_MAX_THREADS : (int)cores);
+    pthread_t threads[SIMILARITY_MAX_THREADS];
+    int started = 0;
+    for (int t = 0; t < numThreads; t++){
+        if (pthread_create(&threads[t], NULL, similarity_join_worker, &job) != 0) break;
+        started++;
+    }
+    if (started == 0) similarity_join_worker(&job);
+    for (int t = 0; t < started; t++){
+        pthread_join(threads[t], NULL);
+    }
+
+    /* guardar resultado */
+    FILE *fp = fopen(path, "wb");
+    if (!fp){
+        printf("ERROR: No se pudo guardar el archivo '%s'\n", path);
+    }
+    else {
+        const char magic[8] = "DGTOPK1";
+        int k = SIMILARITY_TOP_K;
+        fwrite(magic, sizeof(magic), 1, fp);
+        fwrite(&k, sizeof(int), 1, fp);
+        fwrite(&numNodes, sizeof(int), 1, fp);
+        for (int id = 0; id < numNodes; id++){
+            for (int i = 0; i < SIMILARITY_TOP_K; i++){
+                fwrite(&job.topIds[(size_t)id * SIMILARITY_TOP_K + i], sizeof(int), 1, fp);
+                fwrite(&job.topSimilarities[(size_t)id * SIMILARITY_TOP_K + i], sizeof(float), 1, fp);
+            }
+        }
+        fclose(fp);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+    double elapsed = (endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) / 1e9;
+    double allPairs = (double)numUsers * (numUsers - 1);
+    printf("Similitudes precalculadas para %d usuarios (top %d) en %.3f s con %d hilo(s)\n", numUsers, SIMILARITY_TOP_K, elapsed, started ? started : 1);
+    printf("Pares comparados: %ld (%.2f%% de todos los pares)\n", job.comparisons, allPairs > 0 ? 100.0 * job.comparisons / allPairs : 0.0);
+    printf("Entradas de las listas de intereses recorridas: %ld (%.2f%% de todos los pares)\n", job.scanned, allPairs > 0 ? 100.0 * job.scanned / allPairs : 0.0);
+    printf("Resultado guardado en '%s'\n", path);
+
+    free(userIds);
+    free(sizes);
+    free(bits);
+    free(tokenOffsets);
+    free(tokens);
+    free(postingOffsets);
+    free(postings);
+    free(job.topIds);
+    free(job.topSimilarities);
+}
+
+/**
+ * @brief Lee los usuarios más similares precalculados de un usuario
+ *
+ * @param path Archivo generado por @see compute_similarity_join
+ * @param graph Grafo de usuarios
+ * @param user Usuario
+ * @param ids Arreglo de SIMILARITY_TOP_K elementos donde se guardan los ids
+ * @param similarities Arreglo de SIMILARITY_TOP_K elementos donde se guardan las similitudes
+ * @return int Cantidad de usuarios leídos, -1 si el archivo no existe o no corresponde a la base de datos actual
+ */
+int read_similar_users(const char *path, Graph graph, User user, int *ids, float *similarities){
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return -1;
+
+    char magic[8];
+    int k, numNodes;
+    if (fread(magic, sizeof(magic), 1, fp) != 1 || memcmp(magic, "DGTOPK1", 8) != 0 ||
+        fread(&k, sizeof(int), 1, fp) != 1 || fread(&numNodes, sizeof(int), 1, fp) != 1 ||
+        k != SIMILARITY_TOP_K || numNodes != graph->nextId || user->id < 0 || user->id >= numNodes){
+        fclose(fp);
+        return -1;
+    }
+
+    long offset = (long)(sizeof(magic) + 2 * sizeof(int)) + (long)user->id * k * (long)(sizeof(int) + sizeof(float));
+    if (fseek(fp, offset, SEEK_SET) != 0){
+        fclose(fp);
+        return -1;
+    }
+    int count = 0;
+    for (int i = 0; i < k; i++){
+        int id;
+        float similarity;
+        if (fread(&id, sizeof(int), 1, fp) != 1 || fread(&similarity, sizeof(float), 1, fp) != 1) break;
+        if (id < 0 || !get_user_by_id(graph, id)) continue;
+        ids[count] = id;
+        similarities[count] = similarity;
+        count++;
+    }
+    fclose(fp);
+    return count;
+}
@@ -28,31 +28,52 @@ User create_new_user(const char *username, const char *password, const char *nam
         printf("Error: El nombre de usuario '%s' ya existe\n", username);
         return NULL;
     }
+    return create_user_from_data(arena_strdup(username), arena_strdup(password), arena_strdup(name), init_user_interests(globalInterests), table, graph);
+}
 
-    User user = (User)malloc(sizeof(_User));
-    if (!user){
-        printf("ERROR: No hay memoria suficiente\n");
-        exit(EXIT_FAILURE);
+/**
+ * @brief Crea un nuevo usuario usando directamente los datos recibidos, sin copiarlos
+ *
+ * @param username Nombre de usuario
+ * @param password Contraseña
+ * @param name Nombre completo
+ * @param interests Conjunto de bits de intereses
+ * @param table Tabla hash
+ * @param graph Grafo de usuarios
+ * @return User Usuario creado o NULL si el nombre de usuario ya existe (los datos siguen siendo del llamador)
+ *
+ * @note Los datos pasan a ser del usuario; pueden estar en el snapshot mapeado (@see free_database_memory)
+ */
+User create_user_from_data(char *username, char *password, char *name, InterestTable interests, PtrToHashTable table, Graph graph){
+    if (search_in_hash_table(table, username)){
+        printf("Error: El nombre de usuario '%s' ya existe\n", username);
+        return NULL;
     }
-    user->id = jenkins_hash(username);
 
-    user->username = strdup(username);
-    user->password = strdup(password);
-    user->name = strdup(name);
+    User user = (User)pool_alloc(POOL_USERS);
+    user->id = -1; // se asigna al añadirlo al grafo
+
+    user->username = username;
+    user->password = password;
+    user->name = name;
     user->posts = create_empty_userPosts();
 
-    user->following = init_empty_edge();
-    user->followers = init_empty_edge();
+    user->following = init_adjacency();
+    user->followers = init_adjacency();
     user->numFollowing = 0;
     user->numFollowers = 0;
 
     user->popularity = 0;
-    user->interests = init_user_interests(globalInterests);
+    user->interests = interests;
 
     // Inicializar amigabilidad y categoría
     user->friendliness = 0.0f;
     user->category = NULL;
 
+    // Un usuario nuevo aún no tiene nada guardado
+    user->dirty = USER_DIRTY_ALL;
+    user->savedPosts = 0;
+
     insert_into_hash_table(table, username, user);
     add_user_to_graph(graph, user);
 
@@ -65,15 +86,11 @@ User create_new_user(const char *username, const char *password, const char *nam
  * @return UserPosts
  */
 UserPosts create_empty_userPosts(void){
-    UserPosts posts = (UserPosts)malloc(sizeof(PostNode));
-    if (!posts){
-        printf("ERROR: No hay memoria suficiente\n");
-        exit(EXIT_FAILURE);
-    }
+    UserPosts posts = (UserPosts)pool_alloc(POOL_POSTS);
     time_t t = time(NULL);
 
     posts->id = 0;
-    posts->date = *localtime(&t);
+    localtime_r(&t, &posts->date);
     posts->post = NULL;
     posts->next = NULL;
     return posts;
@@ -100,7 +117,7 @@ char* generate_post(char* buffer, size_t longitud, User user, GlobalInterests gl
     const char* acomp = acompanamiento[rand() % acompanamientos];
     int aux = rand() % globalInterests.numInterests;
 
-    while (user->interests[aux].value == 0) {
+    while (!has_interest(user->interests, aux)) {
         aux = rand() % globalInterests.numInterests;
     }
     
@@ -145,15 +162,11 @@ UserPosts generate_random_posts(User user, GlobalInterests globalInterests) {
  */
 PtrToPostNode insert_post(UserPosts posts, char *content){
     
-    PtrToPostNode newPost = (PtrToPostNode)malloc(sizeof(PostNode));
-    if (!newPost){
-        printf("ERROR: No hay memoria suficiente\n");
-        exit(EXIT_FAILURE);
-    }
+    PtrToPostNode newPost = (PtrToPostNode)pool_alloc(POOL_POSTS);
     time_t t = time(NULL);
     newPost->id = jenkins_hash(content);
-    newPost->date = *localtime(&t);
-    newPost->post = strdup(content);
+    localtime_r(&t, &newPost->date);
+    newPost->post = arena_strdup(content);
     newPost->next = posts->next;
     posts->next = newPost;
     posts->id++;
@@ -166,11 +179,12 @@ PtrToPostNode insert_post(UserPosts posts, char *content){
  * @param posts Lista de posts
  */
 void delete_userPosts(UserPosts posts){
-    if (posts->next != NULL){
-        delete_userPosts(posts->next);
+    while (posts){
+        PtrToPostNode next = posts->next;
+        free_database_memory(posts->post);
+        pool_free(POOL_POSTS, posts);
+        posts = next;
     }
-    free(posts->post);
-    free(posts);
 }
 
 /**
@@ -184,13 +198,14 @@ void delete_user(User user, PtrToHashTable table, Graph graph){
     delete_from_hash_table(table, user->username);
     remove_user_from_graph(graph, user);
     delete_userPosts(user->posts);
-    free(user->username);
-    free(user->password);
-    free(user->name);
-    free_all_edges(user);
+    free_database_memory(user->username);
+    free_database_memory(user->password);
+    free_database_memory(user->name);
+    free_adjacency(user->following);
+    free_adjacency(user->followers);
     free_user_interests(user->interests);
-    if (user->category) free(user->category);
-    free(user);
+    free_database_memory(user->category);
+    pool_free(POOL_USERS, user);
 }
 
 /**
@@ -239,10 +254,12 @@ void print_user(User user, GlobalInterests globalInterestsTable){
  * @param username Nombre usuario
  * @param table Tabla hash de usuarios
  * @return User
+ *
+ * @note Si la base de datos se abrió de forma parcial, carga al usuario y sus conexiones, @see load_user_on_demand
  */
 User search_user(char *username, PtrToHashTable table){
     User u = search_in_hash_table(table, username);
-    return u;
+    return load_user_on_demand(username, u);
 }
 
 /**
@@ -251,15 +268,13 @@ User search_user(char *username, PtrToHashTable table){
  * @param user Usuario
  */
 void print_followers(User user){
-    Edge aux = user->followers->next;
     printf("Seguidores de %s:\n", user->username);
     if(user->numFollowers==0){
         printf("No hay seguidores\n");
         return;
     }
-    while (aux){
-        printf("- %s\n", aux->dest->username);
-        aux = aux->next;
+    for (int i = 0; i < user->followers->size; i++){
+        printf("- %s\n", user->followers->edges[i].dest->username);
     }
 }
 
@@ -270,15 +285,13 @@ void print_followers(User user){
  */
 void print_following(User user){
     print_logo();
-    Edge aux = user->following->next;
     printf("Seguidos de %s:\n", user->username);
     if(user->numFollowing==0){
         printf("No hay seguidos\n");
         return;
     }
-    while (aux){
-        printf("- %s\n", aux->dest->username);
-        aux = aux->next;
+    for (int i = 0; i < user->following->size; i++){
+        printf("- %s\n", user->following->edges[i].dest->username);
     }
 }
 
@@ -302,15 +315,27 @@ void print_all_users(Graph graph){
  *
  * @param table Tabla hash de usuarios
  * @param graph Grafo de usuarios
+ *
+ * @note Como se descartan todos, no se sacan uno por uno de la tabla hash, del grafo ni de las listas de sus vecinos
+ *       (@see delete_user): se recorren una vez, liberando sus intereses y arreglos de aristas, y luego se vacían la tabla y el grafo. Usuarios, adyacencias, posts y strings
+ *       se liberan juntos con los pools y la arena (@see release_all_memory)
  */
 void free_all_users(PtrToHashTable table, Graph graph){
-    GraphList aux = graph->graphUsersList->next;
-    while (aux)
-    {
-        GraphList next = aux->next;
-        delete_user(aux, table, graph);
-        aux = next;
-    }
+    clear_interest_index(graph); // se descarta entero en vez de quitar usuario por usuario
+    for (GraphList aux = graph->graphUsersList->next; aux; aux = aux->next) {
+        /* los strings editados se reservan con malloc; los de la arena solo se marcan y se liberan con ella */
+        free_database_memory(aux->username);
+        free_database_memory(aux->password);
+        free_database_memory(aux->name);
+        free_user_interests(aux->interests);
+        free(aux->following->edges);
+        free(aux->following->index);
+        free(aux->followers->edges);
+        free(aux->followers->index);
+    }
+    clear_graph_users(graph);
+    clear_hash_table(table);
+    release_all_memory();
 }
 
 /* FUNCIONES DE INTERESES */
@@ -326,6 +351,8 @@ GlobalInterests init_global_interests(void){
     GlobalInterests globalInterestTable;
     globalInterestTable.interestsTable = (char **)malloc(numInterests * sizeof(char *));
     globalInterestTable.numInterests = numInterests;
+    globalInterestTable.numWords = (numInterests + INTEREST_WORD_BITS - 1) / INTEREST_WORD_BITS;
+    if (globalInterestTable.numWords == 0) globalInterestTable.numWords = 1;
 
     FILE *file_pointer = fopen("subtopics", "r");
     if (!file_pointer){
@@ -359,20 +386,39 @@ void free_global_interests(GlobalInterests globalInterestTable){
  * @brief Inicializa los intereses de un usuario
  *
  * @param globalInterests Lista de intereses globales
- * @return InterestTable
+ * @return InterestTable Conjunto de bits vacío
  */
 
 InterestTable init_user_interests(GlobalInterests globalInterestTable){
-    InterestTable userInterests = (InterestTable)malloc(globalInterestTable.numInterests * sizeof(Interest));
-
-    for (int i = 0; i < globalInterestTable.numInterests; i++){
-        userInterests[i].value = 0;
-        userInterests[i].globalId = i;
-        userInterests[i].name = globalInterestTable.interestsTable[i];
+    InterestTable userInterests = (InterestTable)calloc(globalInterestTable.numWords, sizeof(InterestWord));
+    if (!userInterests){
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
     }
     return userInterests;
 }
 
+/**
+ * @brief Marca un interés en un conjunto de bits de intereses
+ *
+ * @param userInterests Conjunto de bits de intereses
+ * @param interestId Id del interés global
+ */
+void set_interest(InterestTable userInterests, int interestId){
+    userInterests[interestId / INTEREST_WORD_BITS] |= 1ULL << (interestId % INTEREST_WORD_BITS);
+}
+
+/**
+ * @brief Indica si un conjunto de bits de intereses contiene un interés
+ *
+ * @param userInterests Conjunto de bits de intereses
+ * @param interestId Id del interés global
+ * @return int 1 si lo tiene, 0 si no
+ */
+int has_interest(InterestTable userInterests, int interestId){
+    return (userInterests[interestId / INTEREST_WORD_BITS] >> (interestId % INTEREST_WORD_BITS)) & 1ULL;
+}
+
 
 /**
  * @brief Libera memoria los intereses de un usuario
@@ -380,7 +426,7 @@ InterestTable init_user_interests(GlobalInterests globalInterestTable){
  * @param userInterests
  */
 void free_user_interests(InterestTable userInterests){
-    free(userInterests);
+    free_database_memory(userInterests);
 }
 
 /**
@@ -392,8 +438,8 @@ void free_user_interests(InterestTable userInterests){
 void print_user_interests(InterestTable userInterests, GlobalInterests globalInterestTable){
     for (int i = 0; i < globalInterestTable.numInterests; i++)
     {
-        if(userInterests[i].value==1){
-            printf("%s ", userInterests[i].name);
+        if(has_interest(userInterests, i)){
+            printf("%s ", globalInterestTable.interestsTable[i]);
         }
     }
     printf("\n");
@@ -407,28 +453,28 @@ void print_user_interests(InterestTable userInterests, GlobalInterests globalInt
  * @param globalInterestTable Lista de intereses globales
  * @return double
  * @note Utilizarse en el peso de la conexion
+ * @note Se calcula como popcount(a & b) / popcount(a | b) sobre los conjuntos de bits, de a cuatro palabras por iteración
  */
 double edge_jaccard(User user1, User user2, GlobalInterests globalInterestTable){
     double jaccard;
 
-    int diff = 0, same = 0;
+    const InterestWord *a = user1->interests;
+    const InterestWord *b = user2->interests;
+    int same = 0, all = 0;
+    int i = 0;
 
-    for (int i = 0; i < globalInterestTable.numInterests; i++){
-        if (user1->interests[i].value == 1 && user2->interests[i].value == 1)
-        {
-            same++;
-        }
-        if (user1->interests[i].value == 0 && user2->interests[i].value == 1)
-        {
-            diff++;
-        }
-        if (user1->interests[i].value == 1 && user2->interests[i].value == 0)
-        {
-            diff++;
-        }
+    for (; i + 4 <= globalInterestTable.numWords; i += 4){
+        same += __builtin_popcountll(a[i] & b[i]) + __builtin_popcountll(a[i + 1] & b[i + 1])
+              + __builtin_popcountll(a[i + 2] & b[i + 2]) + __builtin_popcountll(a[i + 3] & b[i + 3]);
+        all += __builtin_popcountll(a[i] | b[i]) + __builtin_popcountll(a[i + 1] | b[i + 1])
+             + __builtin_popcountll(a[i + 2] | b[i + 2]) + __builtin_popcountll(a[i + 3] | b[i + 3]);
+    }
+    for (; i < globalInterestTable.numWords; i++){
+        same += __builtin_popcountll(a[i] & b[i]);
+        all += __builtin_popcountll(a[i] | b[i]);
     }
 
-    jaccard = (double)same / (same + diff);
+    jaccard = (double)same / all;
 
     return 1 - jaccard;
 }
@@ -514,7 +560,7 @@ void generate_users(int quantity, PtrToHashTable table, Graph graph, GlobalInter
             continue;
         }
         for(int j=0; j<rand()%globalInterests.numInterests; j++){
-            add_interest(newUser, globalInterests, rand()% globalInterests.numInterests);
+            add_interest(newUser, graph, globalInterests, rand()% globalInterests.numInterests);
         }
         printf("%d. Usuario creado: %s (%s)\n", i, name, username);
 
@@ -530,46 +576,19 @@ void generate_users(int quantity, PtrToHashTable table, Graph graph, GlobalInter
  * @param globalInterests Tabla de intereses globales
  */
 void generate_random_connections(Graph graph, GlobalInterests globalInterests){
-    PtrToUser currentUser = graph->graphUsersList;
-
     printf("Generando conexiones... Por favor espere\n");
 
-    for (int i = 0; i < graph->usersNumber; i++){
-        if (currentUser == NULL){
-            printf("La lista de usuarios está vacía.\n");
-            return;
-        }
-
-        int randomIndex = rand() % graph->usersNumber;
-
-        currentUser = graph->graphUsersList->next;
-
-        for (int j = 0; j < randomIndex; j++){
-            if (currentUser->next != NULL)
-            {
-                currentUser = currentUser->next;
-            }
-            else{
-                printf("Error: la lista es más corta de lo esperado.\n");
-                return;
-            }
-        }
-
-        //printf("Usuario seleccionado en la iteracion %d: %s\n", i, currentUser->username);
-
-        User randomUser = graph->graphUsersList->next;
-        int random_index = rand() % graph->usersNumber;
+    if (graph->usersNumber == 0){
+        printf("La lista de usuarios está vacía.\n");
+        return;
+    }
 
-        for (int j = 0; j < random_index; j++){
-            randomUser = randomUser->next;
-        }
+    for (int i = 0; i < graph->usersNumber; i++){
+        User currentUser = get_user_by_id(graph, rand() % graph->nextId);
+        User randomUser = get_user_by_id(graph, rand() % graph->nextId);
 
-        if (randomUser != currentUser){
+        if (currentUser && randomUser && randomUser != currentUser){
             add_edge(currentUser, randomUser, globalInterests);
-            //printf("Conectando el usuario '%s' con '%s'.\n", currentUser->username, randomUser->username);
-        }
-        else{
-            //printf("No se puede conectar el usuario '%s' consigo mismo.\n", currentUser->username);
         }
     }
 }
@@ -628,12 +647,22 @@ const char *classify_friendliness(float friendliness){
     }
 }
 
-void add_interest(User user, GlobalInterests globalInterestTable, int interestId){
-    if(interestId>=globalInterestTable.numInterests){
+/**
+ * @brief Agrega un interés a un usuario y lo registra en el índice invertido del grafo
+ *
+ * @param user Usuario
+ * @param graph Grafo de usuarios
+ * @param globalInterestTable Tabla de intereses globales
+ * @param interestId Id del interés global
+ */
+void add_interest(User user, Graph graph, GlobalInterests globalInterestTable, int interestId){
+    if(interestId<0 || interestId>=globalInterestTable.numInterests){
         printf("ERROR: Id de interés inválido\n");
         return;
     }
-    user->interests[interestId].value = 1;
+    set_interest(user->interests, interestId);
+    index_user_interest(graph, user, interestId);
+    user->dirty |= USER_DIRTY_PROFILE;
 }
 
 void print_global_interests(GlobalInterests globalInterestTable){
@@ -658,7 +687,7 @@ void generate_posts_for_everyone(Graph graph, GlobalInterests globalInterests) {
     while (aux) {
         int cant = 0;
         for(int i=0; i<rand()%globalInterests.numInterests; i++){
-            if(aux->interests[i].value==1){
+            if(has_interest(aux->interests, i)){
                 cant++;
             }
         }
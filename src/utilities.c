@@ -17,7 +17,7 @@
  * @brief Calcula el hash de un string
  * 
  * @param key 
- * @return unsigned int
+ * @return unsigned int Hash completo de 32 bits
  */
 unsigned int jenkins_hash(const char* key)
 {
@@ -35,7 +35,7 @@ unsigned int jenkins_hash(const char* key)
    hash ^= (hash >> 11);
    hash += (hash << 15);
 
-   return hash % HASH_TABLE_SIZE;
+   return hash;
 }
 
 /**
@@ -71,17 +71,26 @@ int get_option(int argc, char *argv[]) {
         {"topics", no_argument, 0, 't'},
         {"followlist", no_argument, 0, 'v'},
         {"followerlist", no_argument, 0, 'w'},
+        {"similar", no_argument, 0, 's'},
+        {"recall", no_argument, 0, 'y'},
+        {"simjoin", no_argument, 0, 'j'},
+        {"migrate", no_argument, 0, 'i'},
+        {"compact", no_argument, 0, 'k'},
+        {"serve", no_argument, 0, 'S'},
+        {"client", no_argument, 0, 'C'},
+        {"batch", required_argument, 0, 'b'},
+        {"memory", no_argument, 0, 'M'},
 
         {0, 0, 0, 0}
     };
 
-    while((opt = getopt_long(argc, argv, ":hlog:rpmu:af:n:dceqxtwv", long_options, &opt_index)) != -1){
+    while((opt = getopt_long(argc, argv, ":hlog:rpmu:af:n:dceqxtwvsyjikSCb:M", long_options, &opt_index)) != -1){
 
 		switch(opt){
          // ayuda
 			case 'h':
             print_logo();
-				printf(COLOR_BOLD"COMANDOS DE DEVGRAPH\n-h, --help\t\t\t Muestra esta ayuda\n  -g, --generate <cantidad>\t Genera usuarios aleatorios\n  -c, --clear\t\t\t Borra la base de datos\n  -a, --all\t\t\t Lista todos los usuarios registrados\n  -t, --topics \t\t\t Muestra todos los tópicos disponibles en DevGraph\n\n  -l, --login\t\t\t Inicia sesión\n  -o, --logout\t\t\t Cerrar sesión\n  -r, --register\t\t Registra un nuevo usuario\n  -d, --delete \t\t\t Elimina la cuenta de la sesión actual\n  -e, --edit \t\t\t Permite editar la información de la sesión actual\n\n  -p, --post\t\t\t Publica una publicación\n  -m, --me\t\t\t Muestra el perfil del usuario actual\n  -u, --user <usuario>\t\t Muestra el perfil de un usuario\n  -f, --follow <usuario>\t Sigue a un usuario\n  -n, --unfollow <usuario>\t Deja de seguir a un usuario\n  -w, --followerlist\t\t Muestra tus seguidores\n  -v, --followlist\t\t Muestra tus seguidos\n\n  -q, --feed\t\t\t Muestra los posts seleccionados para ti\n  -x, --connect\t\t\t Muestra los usuarios recomendados para ti\n");
+				printf(COLOR_BOLD"COMANDOS DE DEVGRAPH\n-h, --help\t\t\t Muestra esta ayuda\n  -g, --generate <cantidad>\t Genera usuarios aleatorios\n  -c, --clear\t\t\t Borra la base de datos\n  -a, --all\t\t\t Lista todos los usuarios registrados\n  -t, --topics \t\t\t Muestra todos los tópicos disponibles en DevGraph\n\n  -l, --login\t\t\t Inicia sesión\n  -o, --logout\t\t\t Cerrar sesión\n  -r, --register\t\t Registra un nuevo usuario\n  -d, --delete \t\t\t Elimina la cuenta de la sesión actual\n  -e, --edit \t\t\t Permite editar la información de la sesión actual\n\n  -p, --post\t\t\t Publica una publicación\n  -m, --me\t\t\t Muestra el perfil del usuario actual\n  -u, --user <usuario>\t\t Muestra el perfil de un usuario\n  -f, --follow <usuario>\t Sigue a un usuario\n  -n, --unfollow <usuario>\t Deja de seguir a un usuario\n  -w, --followerlist\t\t Muestra tus seguidores\n  -v, --followlist\t\t Muestra tus seguidos\n\n  -q, --feed [cantidad]\t\t Muestra los posts seleccionados para ti\n  -x, --connect [cantidad]\t Muestra los usuarios recomendados para ti\n  -s, --similar [cantidad]\t Muestra usuarios con intereses similares (búsqueda aproximada)\n  -y, --recall\t\t\t Mide el recall de la búsqueda aproximada\n  -j, --simjoin\t\t\t Precalcula los usuarios más similares de cada usuario\n  -i, --migrate\t\t\t Migra la base de datos a un único archivo (snapshot)\n  -k, --compact\t\t\t Incorpora los cambios del WAL al snapshot\n\n  -S, --serve\t\t\t Mantiene la base de datos cargada y atiende comandos por un socket\n  -C, --client <comando>\t Envía un comando al servidor\n  -b, --batch <archivo>\t\t Ejecuta los comandos de un archivo ('-' para la entrada estándar)\n  -M, --memory\t\t\t Muestra la memoria usada por la base de datos cargada\n");
 				return 0;
             break;
          // iniciar sesión
@@ -155,6 +164,42 @@ int get_option(int argc, char *argv[]) {
          // Mostrar seguidos del usuario
          case 'v':
             return 18;
+            break;
+         // Mostrar usuarios similares (aproximado)
+         case 's':
+            return 19;
+            break;
+         // Medir recall de la búsqueda aproximada
+         case 'y':
+            return 20;
+            break;
+         // Precalcular usuarios similares
+         case 'j':
+            return 21;
+            break;
+         // Migrar la base de datos al snapshot
+         case 'i':
+            return 22;
+            break;
+         // Incorporar el WAL al snapshot
+         case 'k':
+            return 23;
+            break;
+         // Servidor
+         case 'S':
+            return 24;
+            break;
+         // Cliente del servidor
+         case 'C':
+            return 25;
+            break;
+         // Ejecución por lotes
+         case 'b':
+            return 26;
+            break;
+         // Estadísticas de memoria
+         case 'M':
+            return 27;
             break;
 			default:
 				printf("'./devgraph -h' para mostrar ayuda\n");
@@ -245,5 +290,6 @@ void free_structures_and_exit(PtrToHashTable table, Graph graph, GlobalInterests
     free_hash_table(table);
     free_graph(graph);
     free_global_interests(globalInterestsTable);
+    release_all_memory();
     exit(EXIT_FAILURE);
 }
\ No newline at end of file
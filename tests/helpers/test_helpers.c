@@ -0,0 +1,30 @@
+/**
+ * @file test_helpers.c
+ * @brief Funciones compartidas por las pruebas
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#include "test_helpers.h"
+
+/**
+ * @brief Crea un usuario sin intereses
+ *
+ * @param username Nombre de usuario
+ * @param table Tabla hash de usuarios
+ * @param graph Grafo de usuarios
+ * @return User Usuario creado
+ */
+User create_test_user(const char *username, PtrToHashTable table, Graph graph){
+    InterestTable interests = (InterestTable)calloc(1, sizeof(InterestWord));
+    if (!interests) {
+        printf("ERROR: No hay memoria suficiente\n");
+        exit(EXIT_FAILURE);
+    }
+    return create_user_from_data(arena_strdup(username), arena_strdup("clave"), arena_strdup("nombre"), interests, table, graph);
+}
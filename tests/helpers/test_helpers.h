@@ -0,0 +1,22 @@
+/**
+ * @file test_helpers.h
+ * @brief Cabecera para test_helpers.c
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#ifndef TEST_HELPERS_H
+#define TEST_HELPERS_H
+
+#include "graph.h"
+#include "hash_table.h"
+
+/* FUNCIONES COMPARTIDAS POR LAS PRUEBAS */
+User create_test_user(const char *username, PtrToHashTable table, Graph graph);
+
+#endif
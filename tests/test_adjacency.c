@@ -0,0 +1,109 @@
+/**
+ * @file test_adjacency.c
+ * @brief Prueba aleatoria de las adyacencias: seguir y dejar de seguir al azar y comparar con una matriz de referencia
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#include "graph.h"
+#include "hash_table.h"
+#include "helpers/test_helpers.h"
+
+/**
+ * @def TEST_USERS
+ * @brief Cantidad de usuarios de la prueba
+ */
+#define TEST_USERS 400
+
+/**
+ * @def TEST_OPERATIONS
+ * @brief Cantidad de operaciones aleatorias (seguir o dejar de seguir)
+ */
+#define TEST_OPERATIONS 2000000
+
+/**
+ * @def TEST_CELEBRITIES
+ * @brief Cantidad de usuarios que reciben un tercio de los seguimientos, para que sus adyacencias pasen a la tabla hash
+ */
+#define TEST_CELEBRITIES 12
+
+static char follows[TEST_USERS][TEST_USERS]; // follows[a][b] es 1 si a sigue a b
+
+/**
+ * @brief Compara las adyacencias y contadores de los usuarios en [from, TEST_USERS) con la matriz de referencia
+ *
+ * @param users Usuarios
+ * @param from Primer usuario vivo
+ * @return int 0 si coinciden, -1 si no
+ */
+static int check_users(User *users, int from){
+    for (int a = from; a < TEST_USERS; a++) {
+        int numFollowing = 0, numFollowers = 0;
+        for (int b = from; b < TEST_USERS; b++) {
+            numFollowing += follows[a][b];
+            numFollowers += follows[b][a];
+            if ((search_edge(users[a]->following, users[b]) != NULL) != follows[a][b] ||
+                (search_edge(users[b]->followers, users[a]) != NULL) != follows[a][b]) {
+                printf("ERROR: La arista %d -> %d no coincide con la referencia\n", a, b);
+                return -1;
+            }
+        }
+        if (numFollowing != users[a]->numFollowing || numFollowing != users[a]->following->size ||
+            numFollowers != users[a]->numFollowers || numFollowers != users[a]->followers->size) {
+            printf("ERROR: Los contadores del usuario %d no coinciden con la referencia\n", a);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(void){
+    Graph graph = initialize_graph();
+    PtrToHashTable table = create_hash_table();
+    User users[TEST_USERS];
+    char username[32];
+    for (int i = 0; i < TEST_USERS; i++) {
+        snprintf(username, sizeof(username), "usuario%d", i);
+        users[i] = create_test_user(username, table, graph);
+    }
+
+    srand(1);
+    for (int op = 0; op < TEST_OPERATIONS; op++) {
+        int a = rand() % TEST_USERS;
+        int b = rand() % (op % 3 ? TEST_USERS : TEST_CELEBRITIES);
+        if (a == b) continue;
+        if (rand() % 3) {
+            if (add_edge_with_weight(users[a], users[b], 1.0) == follows[a][b]) {
+                printf("ERROR: add_edge_with_weight no detectó bien la arista %d -> %d\n", a, b);
+                return EXIT_FAILURE;
+            }
+            follows[a][b] = 1;
+        } else {
+            if (remove_edge(users[a], users[b]) != follows[a][b]) {
+                printf("ERROR: remove_edge no detectó bien la arista %d -> %d\n", a, b);
+                return EXIT_FAILURE;
+            }
+            follows[a][b] = 0;
+        }
+    }
+    if (check_users(users, 0) != 0) return EXIT_FAILURE;
+
+    // borrar la mitad de los usuarios debe quitar sus aristas de las adyacencias del resto
+    for (int a = 0; a < TEST_USERS / 2; a++) {
+        delete_user(users[a], table, graph);
+        for (int b = 0; b < TEST_USERS; b++) follows[a][b] = follows[b][a] = 0;
+    }
+    if (check_users(users, TEST_USERS / 2) != 0) return EXIT_FAILURE;
+
+    free_all_users(table, graph);
+    free_graph(graph);
+    free_hash_table(table);
+    release_all_memory();
+    printf("OK\n");
+    return EXIT_SUCCESS;
+}
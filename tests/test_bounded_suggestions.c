@@ -0,0 +1,87 @@
+/**
+ * @file test_bounded_suggestions.c
+ * @brief Prueba que las sugerencias de amigos de amigos respetan el límite de saltos de forma exacta
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#include "heaps.h"
+#include "graph.h"
+#include "hash_table.h"
+#include "helpers/test_helpers.h"
+
+/**
+ * @brief Busca la distancia de un usuario entre las sugerencias
+ *
+ * @param h Sugerencias
+ * @param user Usuario
+ * @return double Distancia, o -1 si no fue sugerido
+ */
+static double suggested_distance(heap *h, User user){
+    for (int i = 0; i < h->size; i++) {
+        if (h->posts[i].author == user) return h->posts[i].priority;
+    }
+    return -1;
+}
+
+int main(void){
+    Graph graph = initialize_graph();
+    PtrToHashTable table = create_hash_table();
+    User source = create_test_user("origen", table, graph);
+    User a = create_test_user("a", table, graph);
+    User b = create_test_user("b", table, graph);
+    User bridge = create_test_user("puente", table, graph);
+    User far = create_test_user("lejano", table, graph);
+    User target = create_test_user("destino", table, graph);
+
+    /* el camino más corto al puente tiene 3 saltos (0.3); el más largo, 2 saltos (2.0) y es el único que deja llegar al destino */
+    add_edge_with_weight(source, a, 0.1);
+    add_edge_with_weight(a, b, 0.1);
+    add_edge_with_weight(b, bridge, 0.1);
+    add_edge_with_weight(source, far, 1.0);
+    add_edge_with_weight(far, bridge, 1.0);
+    add_edge_with_weight(bridge, target, 0.1);
+
+    heap suggestions;
+    init_heap(&suggestions, 0);
+    dijkstra_bounded(&suggestions, get_csr_graph(graph), graph, source, 0, 3, 3.0);
+
+    int error = 0;
+    if (suggested_distance(&suggestions, a) != -1 || suggested_distance(&suggestions, far) != -1) {
+        printf("ERROR: Se sugirió un usuario que ya se sigue\n");
+        error = 1;
+    }
+    else if (suggested_distance(&suggestions, b) < 0.19 || suggested_distance(&suggestions, b) > 0.21 ||
+             suggested_distance(&suggestions, bridge) < 0.29 || suggested_distance(&suggestions, bridge) > 0.31) {
+        printf("ERROR: Las distancias de los usuarios cercanos no son las más cortas\n");
+        error = 1;
+    }
+    else if (suggested_distance(&suggestions, target) < 2.09 || suggested_distance(&suggestions, target) > 2.11) {
+        printf("ERROR: No se sugirió el usuario alcanzable en 3 saltos por un camino más largo\n");
+        error = 1;
+    }
+    free_heap(&suggestions);
+
+    /* con 2 saltos el destino ya no se alcanza por ningún camino */
+    init_heap(&suggestions, 0);
+    dijkstra_bounded(&suggestions, get_csr_graph(graph), graph, source, 0, 2, 3.0);
+    if (!error && (suggested_distance(&suggestions, target) != -1 || suggested_distance(&suggestions, bridge) < 1.99 ||
+                   suggested_distance(&suggestions, bridge) > 2.01)) {
+        printf("ERROR: El límite de 2 saltos no se respetó\n");
+        error = 1;
+    }
+    free_heap(&suggestions);
+
+    free_all_users(table, graph);
+    free_graph(graph);
+    free_hash_table(table);
+    release_all_memory();
+    if (error) return EXIT_FAILURE;
+    printf("OK\n");
+    return EXIT_SUCCESS;
+}
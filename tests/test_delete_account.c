@@ -0,0 +1,96 @@
+/**
+ * @file test_delete_account.c
+ * @brief Prueba que una cuenta borrada con el servidor ya cargado no se puede buscar ni seguir
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#include <unistd.h>
+
+#include "commands.h"
+#include "graph.h"
+#include "hash_table.h"
+#include "helpers/test_helpers.h"
+
+/**
+ * @brief Ejecuta un comando como lo hace el servidor y descarta su salida
+ *
+ * @param argc Cantidad de argumentos
+ * @param argv Argumentos, como los del programa
+ * @param sessionUser Usuario que ejecuta el comando, o NULL para usar la sesión iniciada (como un cliente del servidor)
+ * @param input Entrada del comando
+ * @param table Tabla hash de usuarios
+ * @param graph Grafo de usuarios
+ * @param globalInterests Tabla de intereses globales
+ * @return int Resultado del comando
+ */
+static int run(int argc, char *argv[], User sessionUser, char *input, PtrToHashTable table, Graph graph, GlobalInterests globalInterests){
+    char *output;
+    size_t outputLength;
+    int status = run_command_captured(argc, argv, sessionUser, input, strlen(input), &output, &outputLength, table, graph, globalInterests);
+    free(output);
+    return status;
+}
+
+int main(void){
+    // la sesión y la carpeta de la base de datos se crean en un directorio temporal
+    char directory[] = "/tmp/devgraph_test_XXXXXX";
+    if (!mkdtemp(directory) || chdir(directory) != 0 || mkdir("database", 0755) != 0 ||
+        mkdir("database/borrado_data", 0755) != 0 || mkdir("database/borrado_data/posts", 0755) != 0) {
+        printf("ERROR: No se pudo crear el directorio de la prueba\n");
+        return EXIT_FAILURE;
+    }
+
+    Graph graph = initialize_graph();
+    PtrToHashTable table = create_hash_table();
+    GlobalInterests globalInterests = {NULL, 0, 1};
+    create_test_user("borrado", table, graph);
+    User follower = create_test_user("seguidor", table, graph);
+    add_edge_with_weight(follower, search_user("borrado", table), 1.0);
+
+    char *loginArgs[] = {"devgraph.out", "-l"};
+    char *deleteArgs[] = {"devgraph.out", "-d"};
+    char *searchArgs[] = {"devgraph.out", "-u", "borrado"};
+    char *followArgs[] = {"devgraph.out", "-f", "borrado"};
+    int error = 0;
+    if (run(2, loginArgs, NULL, "borrado\nclave\n", table, graph, globalInterests) != COMMAND_OK ||
+        run(2, deleteArgs, NULL, "", table, graph, globalInterests) != COMMAND_OK) {
+        printf("ERROR: No se pudo iniciar sesión y borrar la cuenta\n");
+        error = 1;
+    }
+    else if (access("database/borrado_data", F_OK) == 0) {
+        printf("ERROR: No se borró la carpeta de la cuenta\n");
+        error = 1;
+    }
+    else if (search_user("borrado", table) != NULL || run(3, searchArgs, NULL, "", table, graph, globalInterests) != COMMAND_ERROR) {
+        printf("ERROR: La cuenta borrada se sigue encontrando\n");
+        error = 1;
+    }
+    else if (follower->numFollowing != 0 || follower->following->size != 0) {
+        printf("ERROR: La cuenta borrada sigue entre los seguidos de otro usuario\n");
+        error = 1;
+    }
+    else if (run(3, followArgs, follower, "", table, graph, globalInterests) != COMMAND_ERROR) {
+        printf("ERROR: Se pudo seguir a la cuenta borrada\n");
+        error = 1;
+    }
+
+    free_all_users(table, graph);
+    free_graph(graph);
+    free_hash_table(table);
+    release_all_memory();
+    remove(DATABASE_NEXT_ID_FILE);
+    remove("current.dat");
+    rmdir("database/borrado_data/posts");
+    rmdir("database/borrado_data");
+    rmdir("database");
+    if (chdir("/") == 0) rmdir(directory);
+    if (error) return EXIT_FAILURE;
+    printf("OK\n");
+    return EXIT_SUCCESS;
+}
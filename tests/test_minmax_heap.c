@@ -0,0 +1,94 @@
+/**
+ * @file test_minmax_heap.c
+ * @brief Prueba aleatoria del min-max heap: insertar y extraer por ambos extremos y comparar con un arreglo ordenado
+ * @authors
+ * - Iván Mansilla
+ * - Franco Aguilar
+ * - Diego Sanhueza
+ * - Duvan Figueroa
+ * - Nicolás Álvarez
+ * - Miguel Maripillan
+ */
+
+#include "heaps.h"
+
+/**
+ * @def TEST_ROUNDS
+ * @brief Cantidad de heaps que se llenan y vacían
+ */
+#define TEST_ROUNDS 300
+
+/**
+ * @def TEST_MAX_ITEMS
+ * @brief Cantidad máxima de inserciones por heap
+ */
+#define TEST_MAX_ITEMS 300
+
+/**
+ * @def TEST_PRIORITIES
+ * @brief Cantidad de prioridades distintas, pocas para que haya empates
+ */
+#define TEST_PRIORITIES 50
+
+static int compare_priorities(const void *a, const void *b){
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Extrae el mínimo o el máximo al azar y comprueba que coincide con el extremo de la referencia
+ *
+ * @param h Heap
+ * @param reference Prioridades que quedan en el heap (se ordena y se le quita el extremo extraído)
+ * @param size Cantidad de prioridades de la referencia (se descuenta la extraída)
+ * @return int 0 si coincide, -1 si no
+ */
+static int extract_and_check(heap *h, double *reference, int *size){
+    qsort(reference, *size, sizeof(double), compare_priorities);
+    if (h->size != *size) {
+        printf("ERROR: El heap tiene %d elementos y la referencia %d\n", h->size, *size);
+        return -1;
+    }
+    if (rand() % 2) {
+        if (peek_min(h)->priority != reference[0]) {
+            printf("ERROR: peek_min devolvió %f y el mínimo es %f\n", peek_min(h)->priority, reference[0]);
+            return -1;
+        }
+        extract_min(h, 0);
+        memmove(reference, reference + 1, (--*size) * sizeof(double));
+    } else {
+        if (peek_max(h)->priority != reference[*size - 1]) {
+            printf("ERROR: peek_max devolvió %f y el máximo es %f\n", peek_max(h)->priority, reference[*size - 1]);
+            return -1;
+        }
+        extract_max(h, 0);
+        --*size;
+    }
+    return 0;
+}
+
+int main(void){
+    double reference[TEST_MAX_ITEMS];
+    srand(7);
+    for (int round = 0; round < TEST_ROUNDS; round++) {
+        heap h;
+        init_heap(&h, 0);
+        int items = rand() % TEST_MAX_ITEMS + 1, size = 0;
+        for (int i = 0; i < items; i++) {
+            double priority = rand() % TEST_PRIORITIES + (rand() % 4) / 4.0;
+            insert_new_item(&h, NULL, NULL, priority);
+            reference[size++] = priority;
+            if (rand() % 4 == 0 && extract_and_check(&h, reference, &size) != 0) return EXIT_FAILURE;
+        }
+        while (size > 0) {
+            if (extract_and_check(&h, reference, &size) != 0) return EXIT_FAILURE;
+        }
+        if (h.size != 0 || peek_min(&h) != NULL || peek_max(&h) != NULL) {
+            printf("ERROR: El heap no quedó vacío\n");
+            return EXIT_FAILURE;
+        }
+        free_heap(&h);
+    }
+    printf("OK\n");
+    return EXIT_SUCCESS;
+}